@@ -0,0 +1,88 @@
+//////////////////////////////////////////////////////////////////////
+///  \file  dgaccelerator_dedup.cpp
+///  \brief Near-duplicate frame result cache implementation
+///
+///  Copyright 2023 DeGirum Corporation
+///
+///  Permission is hereby granted, free of charge, to any person obtaining a
+///  copy of this software and associated documentation files (the "Software"),
+///  to deal in the Software without restriction, including without limitation
+///  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///  and/or sell copies of the Software, and to permit persons to whom the
+///  Software is furnished to do so, subject to the following conditions:
+///
+///  The above copyright notice and this permission notice shall be included in
+///  all copies or substantial portions of the Software.
+///
+///  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+///  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+///  DEALINGS IN THE SOFTWARE.
+///
+
+
+#include <algorithm>
+
+#include "dgaccelerator_dedup.h"
+
+///
+/// \brief Computes the 64-bit difference hash (dHash) of a frame
+///
+/// The frame is area-downscaled to 9x8 before the color conversion, then each bit records whether a thumbnail pixel
+/// is brighter than its right neighbour. The hash is insensitive to compression noise and small brightness changes.
+///
+/// \param[in] frame BGR frame at processing resolution
+/// \return The hash
+///
+uint64_t DgAcceleratorDHash( const cv::Mat &frame )
+{
+	cv::Mat small, gray;
+	cv::resize( frame, small, cv::Size( 9, 8 ), 0, 0, cv::INTER_AREA );
+	cv::cvtColor( small, gray, cv::COLOR_BGR2GRAY );
+
+	uint64_t hash = 0;
+	for( int y = 0; y < 8; y++ )
+	{
+		const unsigned char *row = gray.ptr< unsigned char >( y );
+		for( int x = 0; x < 8; x++ )
+			hash = ( hash << 1 ) | ( row[ x ] > row[ x + 1 ] );
+	}
+	return hash;
+}
+
+const DgAcceleratorOutput *DgAcceleratorResultCache::find( uint64_t hash )
+{
+	for( size_t i = 0; i < m_entries.size(); i++ )
+	{
+		if( (unsigned)__builtin_popcountll( m_entries[ i ].hash ^ hash ) > m_params.hammingThreshold )
+			continue;
+		if( m_entries[ i ].reused >= m_params.maxReuse )
+		{
+			// Force the frame to be inferred, its results then replace the entry
+			m_entries.erase( m_entries.begin() + i );
+			return nullptr;
+		}
+		m_entries[ i ].reused++;
+		// Move the entry to the front to keep the least recently used one last
+		std::rotate( m_entries.begin(), m_entries.begin() + i, m_entries.begin() + i + 1 );
+		return &m_entries.front().output;
+	}
+	return nullptr;
+}
+
+void DgAcceleratorResultCache::insert( uint64_t hash, const DgAcceleratorOutput &output )
+{
+	if( m_params.capacity == 0 )
+		return;
+	if( m_entries.size() < m_params.capacity )
+		m_entries.emplace_back();
+	// Recycle the least recently used entry and move it to the front
+	std::rotate( m_entries.begin(), m_entries.end() - 1, m_entries.end() );
+	m_entries.front().hash = hash;
+	m_entries.front().output = output;
+	m_entries.front().reused = 0;
+	m_entries.front().output.inferred = false;  // Cached results are not new to the tracker
+}
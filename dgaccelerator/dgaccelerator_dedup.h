@@ -0,0 +1,92 @@
+//////////////////////////////////////////////////////////////////////
+///  \file  dgaccelerator_dedup.h
+///  \brief Near-duplicate frame result cache header file
+///
+///  Copyright 2023 DeGirum Corporation
+///
+///  Permission is hereby granted, free of charge, to any person obtaining a
+///  copy of this software and associated documentation files (the "Software"),
+///  to deal in the Software without restriction, including without limitation
+///  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///  and/or sell copies of the Software, and to permit persons to whom the
+///  Software is furnished to do so, subject to the following conditions:
+///
+///  The above copyright notice and this permission notice shall be included in
+///  all copies or substantial portions of the Software.
+///
+///  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+///  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+///  DEALINGS IN THE SOFTWARE.
+///
+
+
+#ifndef __DGACCELERATOR_DEDUP__
+#define __DGACCELERATOR_DEDUP__
+
+#include <cstdint>
+#include <vector>
+
+// OpenCV
+#include "opencv2/imgproc/imgproc.hpp"
+
+#include "dgaccelerator_lib.h"
+
+/// \brief Computes the 64-bit difference hash (dHash) of a frame
+/// \param[in] frame BGR frame at processing resolution
+/// \return Hash with one bit per horizontal gradient sign of a 9x8 grayscale thumbnail
+uint64_t DgAcceleratorDHash( const cv::Mat &frame );
+
+///
+/// \brief Per-source cache of inference results keyed by frame hash
+///
+/// Results are looked up by the Hamming distance between frame hashes, so frames of a frozen, looping or repeating
+/// feed can reuse the results of an earlier, nearly identical frame. The cache holds a few entries in least recently
+/// used order. An entry which served its maximum number of lookups is dropped, so that a frame matching it is inferred
+/// again: small changes of a live scene may not change the hash.
+///
+class DgAcceleratorResultCache
+{
+public:
+	/// \brief Cache tuning parameters
+	struct Params
+	{
+		unsigned capacity;          //!< Maximum number of cached results
+		unsigned hammingThreshold;  //!< Maximum number of differing hash bits for a frame to match an entry
+		unsigned maxReuse;          //!< Maximum number of lookups served by an entry before it is dropped
+	};
+
+	/// \brief Constructor
+	/// \param[in] params Cache tuning parameters
+	explicit DgAcceleratorResultCache( const Params &params ) : m_params( params ) {}
+
+	/// \brief Looks up the results of a nearly identical frame, marking the entry as most recently used
+	/// \param[in] hash Hash of the frame
+	/// \return Pointer to the cached results, or nullptr if no entry matches or the matching entry was used up
+	const DgAcceleratorOutput *find( uint64_t hash );
+
+	/// \brief Stores the results of a frame, evicting the least recently used entry when full
+	/// \param[in] hash Hash of the frame
+	/// \param[in] output Results of the frame
+	void insert( uint64_t hash, const DgAcceleratorOutput &output );
+
+	/// \brief Number of cached results
+	size_t size() const { return m_entries.size(); }
+
+private:
+	/// \brief Cached results of one frame
+	struct Entry
+	{
+		uint64_t hash;               //!< Hash of the frame
+		DgAcceleratorOutput output;  //!< Results of the frame
+		unsigned reused;             //!< Number of lookups served
+	};
+
+	Params m_params;                 //!< Tuning parameters
+	std::vector< Entry > m_entries;  //!< Entries, most recently used first
+};
+
+#endif
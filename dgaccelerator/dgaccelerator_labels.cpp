@@ -0,0 +1,61 @@
+//////////////////////////////////////////////////////////////////////
+///  \file  dgaccelerator_labels.cpp
+///  \brief Interned result label table implementation
+///
+///  Copyright 2023 DeGirum Corporation
+///
+///  Permission is hereby granted, free of charge, to any person obtaining a
+///  copy of this software and associated documentation files (the "Software"),
+///  to deal in the Software without restriction, including without limitation
+///  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///  and/or sell copies of the Software, and to permit persons to whom the
+///  Software is furnished to do so, subject to the following conditions:
+///
+///  The above copyright notice and this permission notice shall be included in
+///  all copies or substantial portions of the Software.
+///
+///  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+///  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+///  DEALINGS IN THE SOFTWARE.
+///
+
+
+#include <limits>
+
+#include "dgaccelerator_labels.h"
+
+DgAcceleratorLabelTable::DgAcceleratorLabelTable()
+{
+	m_names.emplace_back();
+	m_ids.emplace( std::string(), 0 );
+}
+
+uint16_t DgAcceleratorLabelTable::intern( const std::string &label )
+{
+	std::lock_guard< std::mutex > lock( m_mutex );
+	const auto found = m_ids.find( label );
+	if( found != m_ids.end() )
+		return found->second;
+	if( m_names.size() > std::numeric_limits< uint16_t >::max() )
+		return 0;
+	const uint16_t id = (uint16_t)m_names.size();
+	m_names.push_back( label );
+	m_ids.emplace( label, id );
+	return id;
+}
+
+const char *DgAcceleratorLabelTable::name( uint16_t id ) const
+{
+	std::lock_guard< std::mutex > lock( m_mutex );
+	return id < m_names.size() ? m_names[ id ].c_str() : m_names[ 0 ].c_str();
+}
+
+size_t DgAcceleratorLabelTable::size() const
+{
+	std::lock_guard< std::mutex > lock( m_mutex );
+	return m_names.size();
+}
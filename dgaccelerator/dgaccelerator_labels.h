@@ -0,0 +1,69 @@
+//////////////////////////////////////////////////////////////////////
+///  \file  dgaccelerator_labels.h
+///  \brief Interned result label table header file
+///
+///  Copyright 2023 DeGirum Corporation
+///
+///  Permission is hereby granted, free of charge, to any person obtaining a
+///  copy of this software and associated documentation files (the "Software"),
+///  to deal in the Software without restriction, including without limitation
+///  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///  and/or sell copies of the Software, and to permit persons to whom the
+///  Software is furnished to do so, subject to the following conditions:
+///
+///  The above copyright notice and this permission notice shall be included in
+///  all copies or substantial portions of the Software.
+///
+///  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+///  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+///  DEALINGS IN THE SOFTWARE.
+///
+
+
+#ifndef __DGACCELERATOR_LABELS__
+#define __DGACCELERATOR_LABELS__
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+///
+/// \brief Per-model dictionary of result labels
+///
+/// Results carry a 16-bit label ID instead of a copy of their label string. Labels are interned the first time the
+/// model reports them, and resolved back to strings only when metadata is attached. ID 0 is the empty label, so
+/// zero-initialized results have no label. The table is shared between the callback thread, which interns, and the
+/// streaming thread, which resolves.
+///
+class DgAcceleratorLabelTable
+{
+public:
+	/// \brief Constructor, creating the empty label
+	DgAcceleratorLabelTable();
+
+	/// \brief Returns the ID of a label, adding the label on first sight
+	/// \param[in] label The label
+	/// \return ID of the label, 0 if the table is full
+	uint16_t intern( const std::string &label );
+
+	/// \brief Returns the label of an ID
+	/// \param[in] id ID returned by intern()
+	/// \return The label, valid for the lifetime of the table; empty for unknown IDs
+	const char *name( uint16_t id ) const;
+
+	/// \brief Number of labels, including the empty label
+	size_t size() const;
+
+private:
+	mutable std::mutex m_mutex;                         //!< Guards the table against concurrent interning
+	std::unordered_map< std::string, uint16_t > m_ids;  //!< Label IDs, by label
+	std::deque< std::string > m_names;                  //!< Labels, by ID; a deque so that returned strings never move
+};
+
+#endif
@@ -25,7 +25,16 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
 
 // OpenCV
 #include "opencv2/highgui/highgui.hpp"
@@ -35,16 +44,17 @@
 #include "client/dg_client.h"
 #include "dg_file_utilities.h"
 #include "dg_model_api.h"
+#include "dgaccelerator_dedup.h"
+#include "dgaccelerator_labels.h"
 #include "dgaccelerator_lib.h"
+#include "dgaccelerator_meta.h"
+#include "dgaccelerator_motion.h"
+#include "dgaccelerator_registry.h"
+#include "dgaccelerator_tiling.h"
+#include "dgaccelerator_tracker.h"
 #include "gstdgaccelerator.h"
 #include "json.hpp"
 
-/// \brief long double json
-using json_ld = nlohmann::basic_json< std::map, std::vector, std::string, bool, std::int64_t, std::uint64_t, long double >;
-
-int NUM_INPUT_STREAMS;  //!< Number of input streams
-int RING_BUFFER_SIZE;   //!< Size of circular queue of output objects
-int FRAME_DIFF_LIMIT;   //!< Maximum number of frames waiting to be processed
 #define DEFAULT_EAGER_BATCH_SIZE          8                                          //!< Default eager batch size
 #define DEFAULT_INPUT_RAW_DATA_TYPE       "DG_UINT8"                                 //!< Default input raw data type
 #define DEFAULT_OUTPUT_POSTPROCESS_TYPE   "None"                                     //!< Default output postprocess type
@@ -56,8 +66,16 @@ int FRAME_DIFF_LIMIT;   //!< Maximum number of frames waiting to be processed
 #define DEFAULT_MAX_CLASSES_PER_DETECTION 30                                         //!< Default maximum classes per detection
 #define DEFAULT_USE_REGULAR_NMS           true                                       //!< Default use regular NMS
 
+/// \brief JPEG quality of the frames submitted to the models
+constexpr int JPEG_QUALITY = 85;
+/// \brief Format of the frames submitted to the models, identifying encodings which can be shared between models
+static const std::string ENCODING_FORMAT = "jpeg:" + std::to_string( JPEG_QUALITY );
+
+/// \brief Delay before the first reconnection attempt to a failed server
+constexpr std::chrono::milliseconds RECONNECT_MIN_DELAY( 500 );
+
 // parseOutput function declaration
-void parseOutput( const json &response, const unsigned int &index, std::vector< DgAcceleratorOutput * > out, DgAcceleratorCtx *ctx );
+void parseOutput( const json &response, DgAcceleratorOutput *output, DgAcceleratorCtx *ctx );
 
 /// \brief Enum to hold the types of models
 enum ModelType
@@ -83,23 +101,567 @@ ModelType determineModelType( const json &response )
 	return CLASSIFICATION;
 }
 
+/// \brief Secondary mode: classification results kept for an object
+struct DgAcceleratorObjectEntry
+{
+	std::vector< DgAcceleratorClassObject > classes;  //!< Latest classification results of the object
+	uint64_t submittedFrame = 0;                      //!< Frame of the source at which the object was last submitted
+	uint64_t seenFrame = 0;                           //!< Frame of the source at which the object was last seen
+	bool submitted = false;                           //!< Whether the object was submitted at least once
+};
+
+/// \brief Secondary mode: object crop waiting for its results
+struct DgAcceleratorPendingObject
+{
+	unsigned int source_id;  //!< Source ID of the object
+	uint64_t object_id;      //!< Object ID, or index in the frame for untracked objects
+	bool tracked;            //!< Whether the object has a tracker ID
+};
+
+/// \brief Server hosting an instance of the model, with its health and latency statistics
+struct DgAcceleratorServer
+{
+	std::string address;                                                                   //!< Server address
+	std::unique_ptr< DgAcceleratorModelConnection > model;                                 //!< Connection to the model instance on the server
+	std::atomic< size_t > outstanding{ 0 };                                                //!< Number of requests waiting for their results
+	size_t submitted = 0;                                                                  //!< Number of requests submitted
+	size_t completed = 0;                                                                  //!< Number of results received
+	size_t errors = 0;                                                                     //!< Number of results reporting an error
+	double latencyTotal = 0;                                                               //!< Sum of the request latencies, in milliseconds
+	double latencyMax = 0;                                                                 //!< Maximum request latency, in milliseconds
+	std::unordered_map< std::string, std::chrono::steady_clock::time_point > submitTimes;  //!< Submission times of outstanding requests
+	std::mutex mutex;                                                                      //!< Guards the statistics against the callback thread
+	// Reconnection
+	std::string host;                                                                      //!< Address the model instance connects to
+	std::function< void( const json &, const std::string & ) > callback;                   //!< Callback of the model instance
+	std::mutex modelMutex;                                                                 //!< Guards model against the reconnection thread
+	std::atomic< bool > down{ false };                                                     //!< Whether the instance failed and waits to be reconnected
+	std::chrono::milliseconds retryDelay{ 0 };                                             //!< Current delay between reconnection attempts
+	std::chrono::steady_clock::time_point retryTime;                                       //!< Time of the next reconnection attempt
+};
+
+/// \brief State kept for each source
+struct DgAcceleratorSource
+{
+	std::unique_ptr< DgAcceleratorTracker > tracker;        //!< Built-in tracker, created on first use
+	std::unique_ptr< DgAcceleratorMotionGate > motionGate;  //!< Motion gate, created on first use
+	std::unique_ptr< DgAcceleratorResultCache > cache;      //!< Near-duplicate frame result cache, created on first use
+	DgAcceleratorOutput lastOutput = {};                    //!< Latest inference results of the source, written by the callback
+	DgAcceleratorOutput reusedOutput = {};                  //!< Copy of lastOutput returned for frames which are not submitted
+	bool hasLastOutput = false;                             //!< Whether lastOutput holds results
+	uint64_t lastOutputSequence = 0;                        //!< Submission sequence number of the frame lastOutput belongs to
+	std::vector< DgAcceleratorTile > tiles;                 //!< Tile layout of the source in tiling mode
+	int tiledWidth = 0;                                     //!< Width of the region the tile layout was computed for
+	int tiledHeight = 0;                                    //!< Height of the region the tile layout was computed for
+	DgAcceleratorOutput tiledOutput = {};                   //!< Merged results of the tiles of the source
+	DgAcceleratorMaskUpscaler maskUpscaler;                 //!< Upscaler of the segmentation class maps of the source to frame resolution
+	std::unordered_map< uint64_t, DgAcceleratorObjectEntry > objects;           //!< Secondary mode: results of tracked objects, by object ID
+	std::unordered_map< uint64_t, DgAcceleratorObjectEntry > untrackedObjects;  //!< Secondary mode: results of untracked objects of the current frame
+	uint64_t frame = 0;                                                         //!< Secondary mode: number of frames of the source processed
+};
+
 /// \brief Context for the element, holds parameters for the model and a smart pointer to the model
 struct DgAcceleratorCtx
 {
 	bool drop_frames;                           //!< Toggle for dropping frames
 	gint processing_width;                      //!< Processing width of the model
 	gint processing_height;                     //!< Processing height of the model
-	std::unique_ptr< DG::AIModelAsync > model;  //!< Smart pointer to the model
-	size_t diff = 0;                            //!< Counter for the number of frames waiting for callback at any given moment
-	size_t framesProcessed = 0;                 //!< Frame count for FPS calculation.
+	std::vector< std::unique_ptr< DgAcceleratorServer > > servers;  //!< Servers hosting an instance of the model
+	size_t nextServer = 0;                                          //!< Server preferred on ties by the scheduler, rotated for round robin
+	std::atomic< size_t > diff{ 0 };                                //!< Counter for the number of frames waiting for callback at any given moment
+	std::atomic< size_t > framesProcessed{ 0 };                     //!< Frame count for FPS calculation.
 	unsigned int curIndex;                      //!< Circular buffer index implementation
+	int numInputStreams;                        //!< Number of input streams
+	int ringBufferSize;                         //!< Size of circular queue of output objects
+	size_t frameDiffLimit;                      //!< Maximum number of frames waiting to be processed
 	std::chrono::time_point< std::chrono::high_resolution_clock > start_time;  //!< Clock for counting total duration
 	std::vector< DgAcceleratorOutput * > out;  //!< Vector of pointers to output structs for circular buffer implementation
+	DgAcceleratorOutput emptyOutput = {};      //!< Output returned for skipped frames
+	std::vector< unsigned int > slotSource;    //!< Source ID of the frame submitted to each slot of the circular buffer
+	std::vector< uint64_t > slotHash;          //!< Hash of the frame submitted to each slot of the circular buffer
+	std::vector< uint64_t > slotSequence;      //!< Submission sequence number of the frame in each slot of the circular buffer
+	// Per-source state
+	std::unordered_map< unsigned int, DgAcceleratorSource > sources;  //!< State of each source, by source ID
+	std::mutex sourcesMutex;                                          //!< Guards sources against the callback thread
+	DgAcceleratorTracker::Params trackerParams;                       //!< Parameters for new trackers
+	bool motionGating;                                                //!< Toggle for the motion gate
+	DgAcceleratorMotionGate::Params motionParams;                     //!< Parameters for new motion gates
+	bool caching;                                                     //!< Toggle for the near-duplicate frame result cache
+	DgAcceleratorResultCache::Params cacheParams;                     //!< Parameters for new result caches
+	size_t framesSubmitted = 0;                                       //!< Number of frames submitted for inference
+	size_t framesGated = 0;                                           //!< Number of frames held back by the motion gate
+	size_t framesCached = 0;                                          //!< Number of frames answered from the result cache
+	bool tiling;                                                      //!< Toggle for tiled inference
+	double tileOverlap;                                               //!< Minimum overlap between neighbouring tiles
+	float tileNmsThreshold;                                           //!< Overlap above which boxes of different tiles are merged
+	int slotsPerFrame = 1;                                            //!< Circular buffer slots used by each frame (its number of tiles)
+	std::set< int > classFilter;                                      //!< Class IDs of the results kept by the parser, empty for all
+	double minConfidence;                                             //!< Minimum confidence of the results kept by the parser
+	float minBoxSize;                                                 //!< Minimum width and height of the detections kept by the parser
+	DgAcceleratorLabelTable labels;                                   //!< Labels of the results, interned by the parser
+	DgAcceleratorSkeleton skeleton;                                   //!< Keypoint topology of a pose model, built from its first pose
+	std::once_flag skeletonOnce;                                      //!< Guards building the skeleton
+	std::atomic< bool > skeletonReady{ false };                       //!< Set once the skeleton is built
+	unsigned int reinferInterval;                                     //!< Secondary mode: frames during which the results of a tracked object are reused
+	std::unordered_map< uint64_t, DgAcceleratorPendingObject > pendingObjects;  //!< Secondary mode: submitted object crops, by request number
+	uint64_t nextObjectRequest = 0;                                   //!< Secondary mode: request number of the next object crop
+	DgAcceleratorOutput objectOutput = {};                            //!< Secondary mode: results of an object crop, used by the callback
+	size_t objectsSubmitted = 0;                                      //!< Secondary mode: number of object crops submitted
+	size_t objectsCached = 0;                                         //!< Secondary mode: number of objects answered from earlier results
 	// Error handling
-	bool failed = false;     //!< Flag indicating if an error occurred
-	std::string failReason;  //!< Reason for failure
+	std::atomic< bool > failed{ false };  //!< Flag indicating if an error occurred, set once failReason is written
+	std::string failReason;               //!< Reason for failure, written once by the first failing callback
+	std::mutex failMutex;                 //!< Guards failReason against concurrent callbacks of several servers
+	// Reconnection
+	GstDgAccelerator *element;                     //!< Element receiving the warnings about failed servers
+	std::string modelName;                         //!< The full name of the model, to reconnect failed servers
+	DG::ModelParamsWriter modelParams;             //!< Model parameters, to reconnect failed servers
+	std::string modelParamsKey;                    //!< String identifying the model parameters, to share model instances
+	bool shareConnection;                          //!< Toggle for sharing model instances with other elements of the process
+	bool reconnect;                                //!< Toggle for surviving server errors by reconnecting failed servers
+	std::chrono::milliseconds reconnectMaxDelay;   //!< Maximum delay between reconnection attempts
+	std::thread reconnector;                       //!< Thread reconnecting failed servers
+	std::mutex reconnectMutex;                     //!< Guards reconnectStop
+	std::condition_variable reconnectCondition;    //!< Wakes the reconnection thread up
+	bool reconnectStop = false;                    //!< Flag stopping the reconnection thread
+	std::atomic< size_t > framesLost{ 0 };         //!< Number of frames and objects left without results by server errors
+	// Startup
+	std::chrono::steady_clock::time_point initTime;  //!< Time at which the context started initializing
+	std::atomic< bool > firstResult{ false };        //!< Whether the results of a frame or object were received
+	double timeToFirstResult = 0;                    //!< Time from initTime to the first results, in milliseconds
+};
+
+///
+/// \brief Returns the state of a source, creating it on first use
+///
+/// The map is locked only for the lookup: its elements do not move, and the members used by the callback thread
+/// are guarded separately by sourcesMutex.
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] source_id Source ID
+/// \return Reference to the state of the source
+///
+static DgAcceleratorSource &sourceGet( DgAcceleratorCtx *ctx, unsigned int source_id )
+{
+	std::lock_guard< std::mutex > lock( ctx->sourcesMutex );
+	return ctx->sources[ source_id ];
+}
+
+///
+/// \brief Clears an output struct before new results are parsed into it
+/// \param[in,out] output The output to clear
+///
+static void outputReset( DgAcceleratorOutput *output )
+{
+	// Deallocate memory for Segmentation
+	output->segMap.class_map.reset();  // Release the reference to the class map buffer
+	// Reset values to 0
+	output->numObjects = 0;
+	output->numPoses = 0;
+	output->poses.first[ 0 ] = 0;
+	output->k = 0;
+	output->segMap.element_size = 0;
+	output->segMap.mask_width = 0;
+	output->segMap.mask_height = 0;
+	output->inferred = false;
+}
+
+///
+/// \brief Records an error of the model, raised by the streaming thread when it submits its next frame
+///
+/// Callbacks of several servers may fail concurrently: only the first reason is kept. The reason is written before the
+/// flag is set and never written again, so readers which saw the flag read it without locking.
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] reason Reason for failure
+///
+static void fail( DgAcceleratorCtx *ctx, const std::string &reason )
+{
+	std::lock_guard< std::mutex > lock( ctx->failMutex );
+	if( ctx->failed )
+		return;
+	ctx->failReason = reason;
+	ctx->failed = true;
+}
+
+/// \brief Socket errors of a failed server connection
+static const std::errc TRANSPORT_ERRORS[] = {
+	std::errc::connection_refused,
+	std::errc::connection_reset,
+	std::errc::connection_aborted,
+	std::errc::timed_out,
+	std::errc::broken_pipe,
+	std::errc::network_unreachable,
+	std::errc::network_down,
+	std::errc::network_reset,
+	std::errc::host_unreachable,
+	std::errc::not_connected,
 };
 
+///
+/// \brief Tells whether an error reported by a server is a transport failure, which reconnecting the server may fix
+///
+/// Errors of the model itself (such as invalid model parameters or a failing postprocessor) are reported the same way
+/// by every server and survive reconnection, so they are not recoverable. Only the exact system messages of the socket
+/// errors of a failed connection, and the end of file of a closed one, are recognized: words such as "network" or
+/// "connection" also appear in model errors.
+///
+/// \param[in] error Error message of a response
+/// \return Returns true if the error is a connection or transport failure
+///
+static bool connectionError( const std::string &error )
+{
+	static const std::vector< std::string > messages = []() {
+		std::vector< std::string > result = { "End of file" };
+		for( std::errc code : TRANSPORT_ERRORS )
+			result.push_back( std::make_error_code( code ).message() );
+		return result;
+	}();
+	for( const std::string &message : messages )
+	{
+		if( error.find( message ) != std::string::npos )
+			return true;
+	}
+	return false;
+}
+
+///
+/// \brief Tells whether an exception raised when submitting a request is a transport failure
+///
+/// System errors are classified by their error code, other exceptions by their message.
+///
+/// \param[in] e The exception
+/// \return Returns true if the error is a connection or transport failure
+///
+static bool connectionError( const std::exception &e )
+{
+	if( const std::system_error *systemError = dynamic_cast< const std::system_error * >( &e ) )
+	{
+		for( std::errc code : TRANSPORT_ERRORS )
+		{
+			if( systemError->code() == code )
+				return true;
+		}
+	}
+	return connectionError( std::string( e.what() ) );
+}
+
+///
+/// \brief Secondary mode: drops an object crop left without results by a server error
+///
+/// The object keeps its previous results and is submitted again on its next frame.
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] request Request number of the object crop
+///
+static void objectLost( DgAcceleratorCtx *ctx, uint64_t request )
+{
+	std::lock_guard< std::mutex > lock( ctx->sourcesMutex );
+	auto pending = ctx->pendingObjects.find( request );
+	if( pending == ctx->pendingObjects.end() )
+		return;
+	if( pending->second.tracked )
+	{
+		auto &objects = ctx->sources[ pending->second.source_id ].objects;
+		auto object = objects.find( pending->second.object_id );
+		if( object != objects.end() )
+			object->second.submitted = false;
+	}
+	ctx->pendingObjects.erase( pending );
+	ctx->framesLost++;
+}
+
+///
+/// \brief Drops a frame or object crop left without results by a server error
+///
+/// Frames are marked as not inferred, so they are passed through without results and the tracker extrapolates
+/// its tracks over them.
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] key Frame info of the request
+///
+static void requestLost( DgAcceleratorCtx *ctx, const std::string &key )
+{
+	if( key[ 0 ] == 'w' )
+		return;  // Warm-up frames have no results to drop
+	if( key[ 0 ] == 'o' )
+	{
+		objectLost( ctx, std::stoull( key.substr( 1 ) ) );
+		return;
+	}
+	outputReset( ctx->out[ std::stoi( key ) ] );
+	ctx->framesLost++;
+	ctx->diff--;
+}
+
+///
+/// \brief Secondary mode: stores the results of an object crop, called from the model callback
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] response The JSON response from the model
+/// \param[in] request Request number of the object crop
+///
+static void objectResultsStore( DgAcceleratorCtx *ctx, const json &response, uint64_t request )
+{
+	// Check for errors during inference
+	std::string possible_error = DG::errorCheck( response );
+	if( !possible_error.empty() )
+	{
+		if( ctx->reconnect && connectionError( possible_error ) )
+		{
+			objectLost( ctx, request );
+			return;
+		}
+		fail( ctx, possible_error );
+	}
+	// Results of several servers may arrive concurrently
+	std::lock_guard< std::mutex > lock( ctx->sourcesMutex );
+	outputReset( &ctx->objectOutput );
+	if( !ctx->failed )
+		parseOutput( response, &ctx->objectOutput, ctx );
+
+	auto pending = ctx->pendingObjects.find( request );
+	if( pending == ctx->pendingObjects.end() )
+		return;
+	DgAcceleratorSource &source = ctx->sources[ pending->second.source_id ];
+	auto &objects = pending->second.tracked ? source.objects : source.untrackedObjects;
+	auto object = objects.find( pending->second.object_id );
+	if( object != objects.end() )  // Objects may have been evicted meanwhile
+		object->second.classes.assign( ctx->objectOutput.classifiedObject, ctx->objectOutput.classifiedObject + ctx->objectOutput.k );
+	ctx->pendingObjects.erase( pending );
+}
+
+///
+/// \brief Takes a failed server out of the rotation until the reconnection thread reconnects it
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] server The failed server
+/// \param[in] reason Error reported by the server
+///
+static void serverFailed( DgAcceleratorCtx *ctx, DgAcceleratorServer *server, const std::string &reason )
+{
+	if( server->down.exchange( true ) )
+		return;  // Already waiting to be reconnected
+	{
+		std::lock_guard< std::mutex > lock( ctx->reconnectMutex );
+		server->retryDelay = RECONNECT_MIN_DELAY;
+		server->retryTime = std::chrono::steady_clock::now() + server->retryDelay;
+	}
+	std::cout << "Server " << server->address << " failed, reconnecting: " << reason << "\n";
+	GST_ELEMENT_WARNING(
+		ctx->element, RESOURCE, READ, ( "Server %s failed, frames are passed through without results until it is reconnected.", server->address.c_str() ),
+		( "%s", reason.c_str() ) );
+	ctx->reconnectCondition.notify_one();
+}
+
+///
+/// \brief Submits an encoded frame to the server with the least outstanding requests
+///
+/// Ties are broken round robin. Results are associated with their frame through the key, so completions may arrive
+/// out of order across servers. Servers waiting to be reconnected are skipped.
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] frame The model input vector
+/// \param[in] key Frame info passed back to the callback with the results
+/// \return Returns false if no server is available to infer the frame
+///
+static bool dispatch( DgAcceleratorCtx *ctx, std::vector< std::vector< char > > &frame, const std::string &key )
+{
+	DgAcceleratorServer *server = nullptr;
+	for( size_t n = 0; n < ctx->servers.size(); n++ )
+	{
+		DgAcceleratorServer *candidate = ctx->servers[ ( ctx->nextServer + n ) % ctx->servers.size() ].get();
+		if( candidate->down )
+			continue;
+		if( server == nullptr || candidate->outstanding < server->outstanding )
+			server = candidate;
+	}
+	ctx->nextServer = ( ctx->nextServer + 1 ) % ctx->servers.size();
+	if( server == nullptr )
+		return false;
+	{
+		std::lock_guard< std::mutex > lock( server->mutex );
+		server->submitTimes[ key ] = std::chrono::steady_clock::now();
+		server->submitted++;
+	}
+	server->outstanding++;
+	try
+	{
+		std::lock_guard< std::mutex > lock( server->modelMutex );
+		server->model->predict( frame, key );
+	}
+	catch( const std::exception &e )
+	{
+		if( !ctx->reconnect || !connectionError( e ) )
+			throw;
+		{
+			std::lock_guard< std::mutex > lock( server->mutex );
+			server->submitTimes.erase( key );
+			server->submitted--;
+		}
+		server->outstanding--;
+		serverFailed( ctx, server, e.what() );
+		return dispatch( ctx, frame, key );  // Fail over to the remaining servers
+	}
+	return true;
+}
+
+///
+/// \brief Updates the statistics of a server when it returns results, called from the model callback
+///
+/// \param[in] server The server
+/// \param[in] response The JSON response from the model
+/// \param[in] key Frame info of the results
+///
+static void serverCompleted( DgAcceleratorServer *server, const json &response, const std::string &key )
+{
+	const bool error = !DG::errorCheck( response ).empty();
+	std::lock_guard< std::mutex > lock( server->mutex );
+	auto submitted = server->submitTimes.find( key );
+	if( submitted != server->submitTimes.end() )
+	{
+		const double latency = std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now() - submitted->second ).count();
+		server->latencyTotal += latency;
+		server->latencyMax = std::max( server->latencyMax, latency );
+		server->submitTimes.erase( submitted );
+	}
+	server->completed++;
+	if( error )
+		server->errors++;
+	server->outstanding--;
+}
+
+///
+/// \brief Waits until the results of all submitted frames are received from every server
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+///
+static void waitCompletion( DgAcceleratorCtx *ctx )
+{
+	for( auto &server : ctx->servers )
+	{
+		if( server->down )
+			continue;  // Requests of failed servers are dropped when they are reconnected
+		try
+		{
+			std::lock_guard< std::mutex > lock( server->modelMutex );
+			server->model->waitCompletion();
+		}
+		catch( const std::exception &e )
+		{
+			if( !ctx->reconnect )
+				throw;
+			serverFailed( ctx, server.get(), e.what() );
+		}
+	}
+}
+
+///
+/// \brief Connects the model instance of a server
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] server The server
+///
+static void serverConnect( DgAcceleratorCtx *ctx, DgAcceleratorServer *server )
+{
+	server->model = std::make_unique< DgAcceleratorModelConnection >(
+		server->host,
+		ctx->modelName,
+		ctx->modelParams,
+		ctx->modelParamsKey + server->address.substr( server->host.size() ),  // Connections of a server stay distinct
+		server->callback,
+		ctx->shareConnection );
+}
+
+///
+/// \brief Reconnects a failed server, dropping the requests its failed model instance still holds
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] server The failed server
+/// \return Returns true if the server was reconnected
+///
+static bool serverReconnect( DgAcceleratorCtx *ctx, DgAcceleratorServer *server )
+{
+	std::lock_guard< std::mutex > lock( server->modelMutex );
+	if( server->model )
+	{
+		server->model.reset();
+		std::vector< std::string > lost;
+		{
+			std::lock_guard< std::mutex > statsLock( server->mutex );
+			for( const auto &request : server->submitTimes )
+				lost.push_back( request.first );
+			server->submitTimes.clear();
+		}
+		for( const std::string &key : lost )
+			requestLost( ctx, key );
+		server->outstanding -= lost.size();
+	}
+	try
+	{
+		serverConnect( ctx, server );
+	}
+	catch( const std::exception &e )
+	{
+		std::cout << "Reconnecting server " << server->address << " failed: " << e.what() << "\n";
+		return false;
+	}
+	std::cout << "Server " << server->address << " reconnected\n";
+	GST_ELEMENT_INFO( ctx->element, RESOURCE, READ, ( "Server %s reconnected.", server->address.c_str() ), ( NULL ) );
+	server->down = false;
+	return true;
+}
+
+///
+/// \brief Reconnection thread: retries failed servers with exponential backoff
+///
+/// The delay between attempts starts at RECONNECT_MIN_DELAY and doubles after each failed attempt, up to the maximum set by the
+/// reconnect-max-delay property. Frames keep flowing meanwhile, inferred by the remaining servers if any.
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+///
+static void reconnectLoop( DgAcceleratorCtx *ctx )
+{
+	std::unique_lock< std::mutex > lock( ctx->reconnectMutex );
+	while( !ctx->reconnectStop )
+	{
+		auto wakeup = std::chrono::steady_clock::now() + RECONNECT_MIN_DELAY;
+		for( auto &server : ctx->servers )
+		{
+			if( ctx->reconnectStop )
+				break;
+			if( !server->down )
+				continue;
+			if( std::chrono::steady_clock::now() < server->retryTime )
+			{
+				wakeup = std::min( wakeup, server->retryTime );
+				continue;
+			}
+			lock.unlock();
+			const bool reconnected = serverReconnect( ctx, server.get() );
+			lock.lock();
+			if( !reconnected )
+			{
+				server->retryDelay = std::min( 2 * server->retryDelay, ctx->reconnectMaxDelay );
+				server->retryTime = std::chrono::steady_clock::now() + server->retryDelay;
+				wakeup = std::min( wakeup, server->retryTime );
+			}
+		}
+		ctx->reconnectCondition.wait_until( lock, wakeup );
+	}
+}
+
+///
+/// \brief Initializes the DgAccelerator model set by the model-name property
+///
+/// \param[in] dgaccelerator Pointer to the GstDgAccelerator element for model initialization
+/// \return Returns a pointer to the DgAcceleratorCtx instance
+///
+DgAcceleratorCtx *DgAcceleratorCtxInit( GstDgAccelerator *dgaccelerator )
+{
+	return DgAcceleratorCtxInit(
+		dgaccelerator, { dgaccelerator->model_name, dgaccelerator->processing_width, dgaccelerator->processing_height, -1 } );
+}
+
 ///
 /// \brief Initializes the DgAccelerator model with the given parameters and sets the callback function
 ///
@@ -108,38 +670,75 @@ struct DgAcceleratorCtx
 /// DgAcceleratorCtx instance.
 ///
 /// \param[in] dgaccelerator Pointer to the GstDgAccelerator element for model initialization
+/// \param[in] config Name, processing resolution and confidence threshold of the model
 /// \return Returns a pointer to the DgAcceleratorCtx instance
 ///
-DgAcceleratorCtx *DgAcceleratorCtxInit( GstDgAccelerator *dgaccelerator )
+DgAcceleratorCtx *DgAcceleratorCtxInit( GstDgAccelerator *dgaccelerator, const DgAcceleratorModelConfig &config )
 {
-	DgAcceleratorCtx *ctx = (DgAcceleratorCtx *)calloc( 1, sizeof( DgAcceleratorCtx ) );
+	DgAcceleratorCtx *ctx = new DgAcceleratorCtx();
+	ctx->initTime = std::chrono::steady_clock::now();
 	ctx->drop_frames = dgaccelerator->drop_frames;
-	ctx->processing_width = dgaccelerator->processing_width;
-	ctx->processing_height = dgaccelerator->processing_height;
+	ctx->processing_width = config.width;
+	ctx->processing_height = config.height;
+	ctx->trackerParams = { (float)dgaccelerator->tracker_params.iou_threshold, dgaccelerator->tracker_params.max_age };
+	ctx->motionGating = dgaccelerator->motion_params.threshold > 0;
+	ctx->motionParams = { dgaccelerator->motion_params.threshold, dgaccelerator->motion_params.pixel_threshold, dgaccelerator->motion_params.max_skip };
+	ctx->caching = dgaccelerator->dedup_params.cache_size > 0;
+	ctx->cacheParams = { dgaccelerator->dedup_params.cache_size, dgaccelerator->dedup_params.hamming_threshold, dgaccelerator->dedup_params.max_reuse };
+	ctx->tiling = dgaccelerator->tiling_params.enable;
+	ctx->tileOverlap = dgaccelerator->tiling_params.overlap;
+	ctx->tileNmsThreshold = dgaccelerator->tiling_params.nms_threshold;
+	ctx->reinferInterval = dgaccelerator->secondary_params.reinfer_interval;
+	if( dgaccelerator->class_filter_ids != NULL )
+		ctx->classFilter = *dgaccelerator->class_filter_ids;
+	ctx->minConfidence = dgaccelerator->filter_params.min_confidence;
+	ctx->minBoxSize = dgaccelerator->filter_params.min_box_size;
 	// Initialize number of input streams
-	NUM_INPUT_STREAMS = dgaccelerator->batch_size;
+	ctx->numInputStreams = dgaccelerator->batch_size;
 	// Set the ring buffer size
-	RING_BUFFER_SIZE = 2 * NUM_INPUT_STREAMS;  // 2 * the number of input streams
+	ctx->ringBufferSize = 2 * ctx->numInputStreams;  // 2 * the number of input streams
 	// Set the ceiling for frame skipping
-	FRAME_DIFF_LIMIT = std::max( 3, RING_BUFFER_SIZE - 1 );
+	ctx->frameDiffLimit = std::max( 3, ctx->ringBufferSize - 1 );
 
 	// Initialize the vector of output objects
-	ctx->out.resize( RING_BUFFER_SIZE );
+	ctx->out.resize( ctx->ringBufferSize );
+	ctx->slotSource.resize( ctx->ringBufferSize );
+	ctx->slotHash.resize( ctx->ringBufferSize );
+	ctx->slotSequence.resize( ctx->ringBufferSize );
 	for( auto &elem : ctx->out )
 	{
-		elem = (DgAcceleratorOutput *)calloc( 1, sizeof( DgAcceleratorOutput ) );
+		elem = new DgAcceleratorOutput();
 	}
 	// Initialize curIndex
 	ctx->curIndex = 0;
 
-	const std::string serverIP = dgaccelerator->server_ip;
-	std::string modelNameStr = dgaccelerator->model_name;
+	// server-ip holds a comma separated list of servers, each hosting an instance of the model
+	std::vector< std::string > serverIPs;
+	std::istringstream serverList( dgaccelerator->server_ip );
+	for( std::string serverIP; std::getline( serverList, serverIP, ',' ); )
+	{
+		serverIP.erase( 0, serverIP.find_first_not_of( " \t" ) );
+		serverIP.erase( serverIP.find_last_not_of( " \t" ) + 1 );
+		if( !serverIP.empty() )
+			serverIPs.push_back( serverIP );
+	}
+	if( serverIPs.empty() )
+	{
+		throw std::runtime_error( "No server provided in property server-ip." );
+	}
+	std::string modelNameStr = config.name;
+	ctx->element = dgaccelerator;
+	ctx->modelName = modelNameStr;
+	ctx->reconnect = dgaccelerator->reconnect_params.enable;
+	ctx->reconnectMaxDelay = std::chrono::milliseconds( dgaccelerator->reconnect_params.max_delay );
+	// A model instance cannot be shared if it may be reconnected: the other elements would keep the failed one
+	ctx->shareConnection = dgaccelerator->share_connection && !ctx->reconnect;
 	std::cout << "\n\nINITIALIZING MODEL with IP ";
-	std::cout << serverIP << " and name ";
-	std::cout << dgaccelerator->model_name << "\n";
+	std::cout << dgaccelerator->server_ip << " and name ";
+	std::cout << modelNameStr << "\n";
 
 
-	DG::ModelParamsWriter mparams;  // Model Parameters writer to pass to the model
+	DG::ModelParamsWriter &mparams = ctx->modelParams;  // Model Parameters writer to pass to the model, kept to reconnect
 
 	// Sets the model parameters for each parameter set in model_params
 	// set the eager batch size property
@@ -155,7 +754,9 @@ DgAcceleratorCtx *DgAcceleratorCtxInit( GstDgAccelerator *dgaccelerator )
 		mparams.OutputPostprocessType_set(dgaccelerator->model_params.output_postprocess_type);
 
 	// set the output confidence threshold property
-	if (dgaccelerator->model_params.output_conf_threshold != DEFAULT_OUTPUT_CONF_THRESHOLD)
+	if (config.confThreshold >= 0)
+		mparams.OutputConfThreshold_set(config.confThreshold);
+	else if (dgaccelerator->model_params.output_conf_threshold != DEFAULT_OUTPUT_CONF_THRESHOLD)
 		mparams.OutputConfThreshold_set(dgaccelerator->model_params.output_conf_threshold);
 
 	// set the output NMS threshold property
@@ -182,31 +783,48 @@ DgAcceleratorCtx *DgAcceleratorCtxInit( GstDgAccelerator *dgaccelerator )
 	if (dgaccelerator->model_params.use_regular_nms != DEFAULT_USE_REGULAR_NMS)
 		mparams.UseRegularNMS_set(dgaccelerator->model_params.use_regular_nms);
 
+	// Elements share a model instance only when all of its parameters match
+	std::ostringstream paramsKey;
+	paramsKey << dgaccelerator->model_params.eager_batch_size << ' ' << dgaccelerator->model_params.input_raw_data_type << ' '
+			  << dgaccelerator->model_params.output_postprocess_type << ' '
+			  << ( config.confThreshold >= 0 ? config.confThreshold : dgaccelerator->model_params.output_conf_threshold ) << ' '
+			  << dgaccelerator->model_params.output_nms_threshold << ' ' << dgaccelerator->model_params.output_top_k << ' '
+			  << dgaccelerator->model_params.max_detections << ' ' << dgaccelerator->model_params.max_detections_per_class << ' '
+			  << dgaccelerator->model_params.max_classes_per_detection << ' ' << dgaccelerator->model_params.use_regular_nms << ' '
+			  << dgaccelerator->cloud_token;
+	ctx->modelParamsKey = paramsKey.str();
+
 
 
 	if( modelNameStr.find( '/' ) == std::string::npos )  // Check if requesting a local model
-	{                                                    // Validate model name:
-		std::vector< DG::ModelInfo > modelList;
-		DG::modelzooListGet( serverIP, modelList );
-		auto model_id = DG::modelFind( serverIP, { modelNameStr } );
-		if( model_id.name.empty() )
-		{
-			std::cout << "Model '" + modelNameStr + "' is not found in model zoo";
-			std::cout << "\nAvailable models:\n\n";
-			for( auto m : modelList )
-				std::cout << m.name << ", WxH: " << m.W << "x" << m.H << "\n";
-			throw std::runtime_error( "Model '" + modelNameStr + "' is not found in model zoo" );
-		}
-		// Validate model width/height:
-		if( dgaccelerator->processing_height != model_id.H )
-		{
-			throw std::runtime_error( "Property processing-height does not match model." );
-			return nullptr;
-		}
-		if( dgaccelerator->processing_width != model_id.W )
+	{                                                    // Validate model name on every server:
+		for( const std::string &serverIP : serverIPs )
 		{
-			throw std::runtime_error( "Property processing-width does not match model." );
-			return nullptr;
+			// The zoo listing is cached for the elements of the process
+			const std::vector< DG::ModelInfo > modelList = DgAcceleratorZooList( serverIP, dgaccelerator->zoo_cache_dir );
+			DG::ModelInfo model_id;
+			for( const DG::ModelInfo &m : modelList )
+				if( m.name == modelNameStr )
+					model_id = m;
+			if( model_id.name.empty() )
+			{
+				std::cout << "Model '" + modelNameStr + "' is not found in model zoo of " + serverIP;
+				std::cout << "\nAvailable models:\n\n";
+				for( auto m : modelList )
+					std::cout << m.name << ", WxH: " << m.W << "x" << m.H << "\n";
+				throw std::runtime_error( "Model '" + modelNameStr + "' is not found in model zoo" );
+			}
+			// Validate model width/height:
+			if( config.height != model_id.H )
+			{
+				throw std::runtime_error( "Property processing-height does not match model '" + modelNameStr + "'." );
+				return nullptr;
+			}
+			if( config.width != model_id.W )
+			{
+				throw std::runtime_error( "Property processing-width does not match model '" + modelNameStr + "'." );
+				return nullptr;
+			}
 		}
 	}
 	else  // Cloud model requested, set the token in model params
@@ -225,41 +843,97 @@ DgAcceleratorCtx *DgAcceleratorCtxInit( GstDgAccelerator *dgaccelerator )
 	}
 	// Callback function for parsing the model inference data for a frame
 	auto callback = [ ctx ]( const json &response, const std::string &fr ) {
-		unsigned int index = std::stoi( fr );  // Index of the Output struct to fill
-
-		// Deallocate the output struct prior to working on it:
-		// Deallocate memory for Pose Estimation
-		for( int i = 0; i < ctx->out[ index ]->numPoses; i++ )
+		// Results of a warm-up frame are only checked for errors
+		if( fr[ 0 ] == 'w' )
 		{
-			ctx->out[ index ]->pose[ i ].landmarks.clear();  // Deallocate memory for vector of landmarks
+			std::string possible_error = DG::errorCheck( response );
+			if( !possible_error.empty() && !( ctx->reconnect && connectionError( possible_error ) ) )
+			{
+				fail( ctx, possible_error );
+			}
+			return;
 		}
-		// Deallocate memory for Segmentation
-		ctx->out[ index ]->segMap.class_map.clear();  // Deallocate memory for vector of class_map
-		// Reset values to 0
-		ctx->out[ index ]->numObjects = 0;
-		ctx->out[ index ]->numPoses = 0;
-		ctx->out[ index ]->k = 0;
-		ctx->out[ index ]->segMap.mask_width = 0;
-		ctx->out[ index ]->segMap.mask_height = 0;
+		// Time to first result includes connection, model load and warm-up
+		if( !ctx->firstResult.exchange( true ) )
+			ctx->timeToFirstResult = std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now() - ctx->initTime ).count();
+		// Secondary mode: results of an object crop
+		if( fr[ 0 ] == 'o' )
+		{
+			objectResultsStore( ctx, response, std::stoull( fr.substr( 1 ) ) );
+			return;
+		}
+		unsigned int index = std::stoi( fr );  // Index of the Output struct to fill
+
+		// Reset the output struct prior to working on it
+		outputReset( ctx->out[ index ] );
 
 		// Check for errors during inference
 		std::string possible_error = DG::errorCheck( response );
 		if( !possible_error.empty() )
 		{
-			ctx->failed = true;
-			ctx->failReason = possible_error;
+			// With reconnection, a connection failure only leaves the frame without results, as its output was reset
+			if( ctx->reconnect && connectionError( possible_error ) )
+				ctx->framesLost++;
+			else
+			{
+				fail( ctx, possible_error );
+			}
 			goto fail;
 		}
 		// Parse the json output, fill output structure using processed output
-		parseOutput( response, index, ctx->out, ctx );
+		parseOutput( response, ctx->out[ index ], ctx );
+		ctx->out[ index ]->inferred = true;
+		// Keep the results of the source for frames which will not be submitted
+		if( ctx->motionGating || ctx->caching )
+		{
+			std::lock_guard< std::mutex > lock( ctx->sourcesMutex );
+			DgAcceleratorSource &source = ctx->sources[ ctx->slotSource[ index ] ];
+			// With several connections, results of a source may complete out of order: keep the latest frame's
+			if( ctx->motionGating && ctx->slotSequence[ index ] >= source.lastOutputSequence )
+			{
+				source.lastOutputSequence = ctx->slotSequence[ index ];
+				source.lastOutput = *ctx->out[ index ];
+				source.lastOutput.inferred = false;  // Reused results are not new to the tracker
+				source.hasLastOutput = true;
+			}
+			if( ctx->caching )
+			{
+				if( !source.cache )
+					source.cache = std::make_unique< DgAcceleratorResultCache >( ctx->cacheParams );
+				source.cache->insert( ctx->slotHash[ index ], *ctx->out[ index ] );
+			}
+		}
 	fail:
-		ctx->framesProcessed++;
+		if( index % ctx->slotsPerFrame == 0 )  // Count frames, not tiles
+			ctx->framesProcessed++;
 		ctx->diff--;  // Decrement # of frames waiting to be processed
 	};
 
-	// Initialize the model with the parameters. Internal frame queue size set to 48
-	ctx->model = std::make_unique< DG::AIModelAsync >( serverIP, modelNameStr, callback, mparams, 48u );
-	// runtime error will happen if invalid modelname or server ip is set.
+	// Initialize the model on each server with the parameters, once per connection. Each instance has its own client
+	// connection and callback thread.
+	for( const std::string &serverIP : serverIPs )
+	{
+		for( guint connection = 0; connection < dgaccelerator->connections; connection++ )
+		{
+			auto server = std::make_unique< DgAcceleratorServer >();
+			server->host = serverIP;
+			server->address = serverIP;
+			if( dgaccelerator->connections > 1 )
+				server->address += " #" + std::to_string( connection );
+			server->callback = [ ctx, server = server.get(), callback ]( const json &response, const std::string &fr ) {
+				serverCompleted( server, response, fr );
+				const std::string error = ctx->reconnect ? DG::errorCheck( response ) : std::string();
+				if( !error.empty() && connectionError( error ) )
+					serverFailed( ctx, server, error );
+				callback( response, fr );
+			};
+			serverConnect( ctx, server.get() );
+			// runtime error will happen if invalid modelname or server ip is set.
+			ctx->servers.push_back( std::move( server ) );
+		}
+	}
+	if( ctx->reconnect )
+		ctx->reconnector = std::thread( reconnectLoop, ctx );
 
 	std::cout << "\nMODEL SUCCESSFULLY INITIALIZED\n\n";
 
@@ -268,6 +942,36 @@ DgAcceleratorCtx *DgAcceleratorCtxInit( GstDgAccelerator *dgaccelerator )
 
 	return ctx;
 }
+///
+/// \brief Builds the skeleton of a pose model from the landmarks of its first pose
+///
+/// Connections are listed by the landmarks at both of their ends; each one is kept once, as an ordered pair of
+/// keypoint indices.
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] landmarks The JSON landmarks of a pose
+///
+static void poseSkeletonBuild( DgAcceleratorCtx *ctx, const json &landmarks )
+{
+	const int count = (int)landmarks.size();
+	std::set< std::pair< int, int > > edges;
+	for( int i = 0; i < count; i++ )
+	{
+		const json &landmark = landmarks[ i ];
+		ctx->skeleton.labelIds.push_back( ctx->labels.intern( landmark[ "label" ].get_ref< const std::string & >() ) );
+		if( !landmark.contains( "connect" ) )
+			continue;
+		for( const json &connection : landmark[ "connect" ] )
+		{
+			const int j = connection.get< int >();
+			if( j >= 0 && j < count && j != i )
+				edges.emplace( std::min( i, j ), std::max( i, j ) );
+		}
+	}
+	ctx->skeleton.edges.assign( edges.begin(), edges.end() );
+	ctx->skeletonReady.store( true, std::memory_order_release );
+}
+
 ///
 /// \brief Parses the output of the DgAccelerator model and fills in a DgAcceleratorOutput instance
 ///
@@ -275,14 +979,16 @@ DgAcceleratorCtx *DgAcceleratorCtxInit( GstDgAccelerator *dgaccelerator )
 /// information about inference results. It populates a DgAcceleratorOutput instance with the
 /// inference results. The function is called once for each frame.
 ///
+/// Results rejected by the class-filter, min-confidence and min-box-size properties are dropped here, so they never
+/// cost metadata downstream.
+///
 /// \param[in] response The JSON response from the model
-/// \param[in] index The index of the output instance to populate
-/// \param[in] out A vector of pointers to DgAcceleratorOutput instances to populate
+/// \param[out] output The output instance to populate
 /// \param[in] ctx A pointer to the DgAcceleratorCtx instance
 ///
 /// \return void
 ///
-void parseOutput( const json &response, const unsigned int &index, std::vector< DgAcceleratorOutput * > out, DgAcceleratorCtx *ctx )
+void parseOutput( const json &response, DgAcceleratorOutput *output, DgAcceleratorCtx *ctx )
 {
 	if( response.empty() )
 		return;  // empty frame: no inference results
@@ -291,70 +997,87 @@ void parseOutput( const json &response, const unsigned int &index, std::vector<
 	ModelType type = determineModelType( response );
 	if( type == POSE_ESTIMATION )
 	{
-		int numPoses = 0;
+		DgAcceleratorPoses &poses = output->poses;
 		for( const nlohmann::json &pose : response )
 		{
 			if( !pose.contains( "landmarks" ) || !pose.contains( "score" ) )
 				continue;
+			const float score = pose[ "score" ].get< float >();
+			if( score < ctx->minConfidence )
+				continue;
 
-			if( numPoses >= MAX_OBJ_PER_FRAME )
+			if( output->numPoses >= MAX_OBJ_PER_FRAME )
+				break;
+			const nlohmann::json &landmarks = pose[ "landmarks" ];
+			int k = poses.first[ output->numPoses ];
+			if( k + landmarks.size() > MAX_KEYPOINTS_PER_FRAME )
 				break;
 
+			// The connections and labels of the landmarks are the same for every pose, they are only read once
+			std::call_once( ctx->skeletonOnce, [ & ]() { poseSkeletonBuild( ctx, landmarks ); } );
+
 			// Iterate over all landmarks in the JSON
-			for( const nlohmann::json &landmark : pose[ "landmarks" ] )
+			for( const nlohmann::json &landmark : landmarks )
 			{
-				DgAcceleratorPose::Landmark lm;
-				lm.landmark_class = landmark[ "category_id" ].get< int >();
-				strncpy( lm.label, landmark[ "label" ].get< std::string >().c_str(), DG_MAX_LABEL_SIZE - 1 );
-				lm.label[ DG_MAX_LABEL_SIZE - 1 ] = '\0';
-				lm.connection = landmark[ "connect" ].get< std::vector< int > >();
-				std::vector< double > point = landmark[ "landmark" ].get< std::vector< double > >();
-				lm.point = { point[ 0 ], point[ 1 ] };
-				ctx->out[ index ]->pose[ numPoses ].landmarks.push_back( lm );
+				const nlohmann::json &point = landmark[ "landmark" ];
+				poses.x[ k ] = point[ 0 ].get< float >();
+				poses.y[ k ] = point[ 1 ].get< float >();
+				poses.keypointScore[ k ] = landmark.contains( "score" ) ? landmark[ "score" ].get< float >() : score;
+				poses.classId[ k ] = landmark[ "category_id" ].get< int >();
+				k++;
 			}
-			numPoses++;
+			poses.score[ output->numPoses ] = score;
+			poses.first[ ++output->numPoses ] = k;
 		}
-		ctx->out[ index ]->numPoses = numPoses;
 	}
 	else if( type == OBJ_DETECTION )
 	{
 		// Iterate over all of the detected objects
 		for( int i = 0; i < response.size(); i++ )
 		{
-			if( ctx->out[ index ]->numObjects >= MAX_OBJ_PER_FRAME )
+			if( output->numObjects >= MAX_OBJ_PER_FRAME )
 				break;
-			ctx->out[ index ]->numObjects++;
-			json_ld newresp = response[ i ];  // Output from model is a json array, so convert to single element
-			std::vector< long double > bbox = newresp[ "bbox" ].get< std::vector< long double > >();
-			std::string label = newresp[ "label" ];
-			int category_id = newresp[ "category_id" ].get< int >();
-			long double score = newresp[ "score" ].get< long double >();
-			ctx->out[ index ]->object[ i ] = ( DgAcceleratorObject ){
-				std::roundf( bbox[ 0 ] ),                                               // left
-				std::roundf( bbox[ 1 ] ),                                               // top
-				std::roundf( bbox[ 2 ] - bbox[ 0 ] ),                                   // width
-				std::roundf( bbox[ 3 ] - bbox[ 1 ] ),                                   // height
-				""                                                                      // label, must be of type char[]
+			// Fields are read in place, the detection is never copied
+			const json &detection = response[ i ];
+			const int category_id = detection[ "category_id" ].get< int >();
+			const double score = detection[ "score" ].get< double >();
+			if( score < ctx->minConfidence || ( !ctx->classFilter.empty() && ctx->classFilter.count( category_id ) == 0 ) )
+				continue;
+			const json &bbox = detection[ "bbox" ];
+			const double left = bbox[ 0 ].get< double >(), top = bbox[ 1 ].get< double >();
+			const double right = bbox[ 2 ].get< double >(), bottom = bbox[ 3 ].get< double >();
+			if( right - left < ctx->minBoxSize || bottom - top < ctx->minBoxSize )
+				continue;
+			const uint16_t labelId = ctx->labels.intern( detection[ "label" ].get_ref< const std::string & >() );
+			output->object[ output->numObjects++ ] = ( DgAcceleratorObject ){
+				std::roundf( left ),           // left
+				std::roundf( top ),            // top
+				std::roundf( right - left ),   // width
+				std::roundf( bottom - top ),   // height
+				(float)score,                  // score
+				category_id,                   // classId
+				labelId                        // labelId
 			};
-			snprintf( ctx->out[ index ]->object[ i ].label, 64, "%s", label.c_str() );  // Sets the label
 		}
 	}
 	else if( type == CLASSIFICATION )
 	{
 		for( const nlohmann::json &object : response )
 		{
-			if( ctx->out[ index ]->k >= MAX_OBJ_PER_FRAME )
+			if( output->k >= MAX_OBJ_PER_FRAME )
 				break;
 			if( !object.contains( "label" ) )
 				continue;
-			std::string label = object[ "label" ];
 			double score = object[ "score" ].get< double >();
-			ctx->out[ index ]->classifiedObject[ ctx->out[ index ]->k ] = ( DgAcceleratorClassObject ){
+			int category_id = object.value( "category_id", -1 );
+			if( score < ctx->minConfidence || ( !ctx->classFilter.empty() && ctx->classFilter.count( category_id ) == 0 ) )
+				continue;
+			output->classifiedObject[ output->k ] = ( DgAcceleratorClassObject ){
 				score,
-				""                                                                                                   // label, must be of type char[]
+				category_id,
+				ctx->labels.intern( object[ "label" ].get_ref< const std::string & >() )
 			};
-			snprintf( ctx->out[ index ]->classifiedObject[ ctx->out[ index ]->k ].label, 64, "%s", label.c_str() );  // Sets the label
-			ctx->out[ index ]->k++;
+			output->k++;
 		}
 	}
 	else if( type == SEGMENTATION )
@@ -366,21 +1089,74 @@ void parseOutput( const json &response, const unsigned int &index, std::vector<
 		// Obtain mask height/width from the json
 		size_t mask_width = response[ 0 ][ "shape" ].get< std::vector< int > >()[ 1 ];
 		size_t mask_height = response[ 0 ][ "shape" ].get< std::vector< int > >()[ 2 ];
-		// Now parse the json into an int array mask
+		// Now parse the json into a class map
 		const auto &byte_vector = response[ 0 ][ "data" ].get_binary();
+		const size_t count = mask_width * mask_height;
+		if( byte_vector.size() < count )
+			return;
 
-		ctx->out[ index ]->segMap.mask_width = mask_width;
-		ctx->out[ index ]->segMap.mask_height = mask_height;
-		ctx->out[ index ]->segMap.class_map.resize( mask_width * mask_height );
-		std::copy( byte_vector.begin(), byte_vector.end(), ctx->out[ index ]->segMap.class_map.begin() );
+		// Write the class IDs once into a pooled buffer, in the format used by the element: int32 to be handed over to
+		// model resolution NvDsInferSegmentationMeta without further copies, uint8 otherwise
+		const size_t element_size = ctx->element->segmentation_output == DGACCELERATOR_SEGMENTATION_OUTPUT_MODEL ? sizeof( int ) : 1;
+		output->segMap.class_map = DgAcceleratorMaskConvert( byte_vector.data(), count, 1, element_size );
+		output->segMap.element_size = element_size;
+		output->segMap.mask_width = mask_width;
+		output->segMap.mask_height = mask_height;
 	}
 	else if( type == ERROR || strcmp( response.type_name(), "object" ) == 0 )
 	{  // Model gave a bad result not caught by errorcheck
-		ctx->failed = true;
-		ctx->failReason = response.dump();
+		fail( ctx, response.dump() );
 	}
 }
 
+///
+/// \brief Encodes a frame at processing resolution into the model input
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] data Pointer to the BGR data at processing resolution
+/// \return The JPEG encoded frame, as the model input vector
+///
+static DgAcceleratorEncodedFrame::Data encode( DgAcceleratorCtx *ctx, unsigned char *data )
+{
+	// Extract the mat
+	cv::Mat frameMat( ctx->processing_height, ctx->processing_width, CV_8UC3, data );
+	// encode this mat into a jpeg buffer vector.
+	std::vector< int > param = { cv::IMWRITE_JPEG_QUALITY, JPEG_QUALITY };
+	std::vector< unsigned char > ubuff = {};
+	// Compress the image and store it in the memory buffer that is resized to fit the result.
+	cv::imencode( ".jpeg", frameMat, ubuff, param );
+	return { std::vector< char >( ubuff.begin(), ubuff.end() ) };
+}
+
+///
+/// \brief Encodes a frame at processing resolution and submits it to the model
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] data Pointer to the BGR data at processing resolution
+/// \param[in] slot Circular buffer slot which receives the results
+/// \param[in] source_id Source ID of the frame
+/// \param[in,out] encoded Encodings of the frame shared with other models, reused when one has the same size and format; may be NULL
+///
+static void submit( DgAcceleratorCtx *ctx, unsigned char *data, int slot, unsigned int source_id, DgAcceleratorEncodedFrame *encoded = nullptr )
+{
+	DgAcceleratorEncodedFrame::Data frameVect;
+	const DgAcceleratorEncodedFrame::Data *frame = &frameVect;
+	if( encoded == nullptr )
+		frameVect = encode( ctx, data );
+	else
+		frame = &encoded->get( ctx->processing_width, ctx->processing_height, ENCODING_FORMAT, [ & ]() { return encode( ctx, data ); } );
+	// Remember which source and frame the results of this slot belong to. The tiles of a frame use consecutive slots
+	// from a multiple of slotsPerFrame, and count as one frame as in the callback.
+	if( slot % ctx->slotsPerFrame == 0 )
+		ctx->framesSubmitted++;
+	ctx->slotSource[ slot ] = source_id;
+	ctx->slotSequence[ slot ] = ctx->framesSubmitted;
+	// This passes the data buffer and the current frame output object index to work on. The model takes the frame by
+	// non-const reference but does not modify it, so shared encodings are passed as is.
+	if( !dispatch( ctx, const_cast< DgAcceleratorEncodedFrame::Data & >( *frame ), std::to_string( slot ) ) )  // Call the predict function
+		requestLost( ctx, std::to_string( slot ) );          // Every server is waiting to be reconnected
+}
+
 ///
 /// \brief Main process function for the DgAccelerator model
 ///
@@ -390,14 +1166,16 @@ void parseOutput( const json &response, const unsigned int &index, std::vector<
 ///
 /// \param[in] ctx Pointer to the DgAcceleratorCtx instance
 /// \param[in] data Pointer to the input data as a OpenCV mat
+/// \param[in] source_id Source ID of the frame
+/// \param[in,out] encoded Encodings of data shared between models: reused when a model of the same resolution and
+/// encoding format encoded the frame, added to when this call encodes the frame. May be NULL.
 /// \return Returns a pointer to the DgAcceleratorOutput instance
 ///
-DgAcceleratorOutput *DgAcceleratorProcess( DgAcceleratorCtx *ctx, unsigned char *data )
+DgAcceleratorOutput *DgAcceleratorProcess( DgAcceleratorCtx *ctx, unsigned char *data, unsigned int source_id, DgAcceleratorEncodedFrame *encoded )
 {
-	ctx->diff++;  // Increment # of frames waiting to be processed
 	// Immediately need to add to curIndex so that the circular buffer can keep going
-	// Wrap around RING_BUFFER_SIZE for circular buffer implementation
-	ctx->curIndex %= RING_BUFFER_SIZE;
+	// Wrap around the ring buffer size for circular buffer implementation
+	ctx->curIndex %= ctx->ringBufferSize;
 	int curFrameIndex = ctx->curIndex++;
 
 	// If an error happens during inference (such as runtime model parameter validation)
@@ -406,27 +1184,61 @@ DgAcceleratorOutput *DgAcceleratorProcess( DgAcceleratorCtx *ctx, unsigned char
 		throw std::runtime_error( ctx->failReason );
 	}
 
+	// Motion gate: static frames reuse the last results of their source. Frames which are not submitted leave their
+	// slot empty, so that no results are left in it for the next frame using the slot.
+	DgAcceleratorMotionGate *gate = nullptr;
+	if( ctx->motionGating && data != NULL )
+	{
+		cv::Mat frameMat( ctx->processing_height, ctx->processing_width, CV_8UC3, data );
+		DgAcceleratorSource &source = sourceGet( ctx, source_id );
+		if( !source.motionGate )
+			source.motionGate = std::make_unique< DgAcceleratorMotionGate >( ctx->motionParams );
+		gate = source.motionGate.get();
+		if( !gate->check( frameMat ) )
+		{
+			ctx->framesGated++;
+			outputReset( ctx->out[ curFrameIndex ] );
+			std::lock_guard< std::mutex > lock( ctx->sourcesMutex );
+			if( !source.hasLastOutput )
+				return &ctx->emptyOutput;
+			source.reusedOutput = source.lastOutput;
+			return &source.reusedOutput;
+		}
+	}
+
+	// Result cache: frames nearly identical to a recently inferred one reuse its results
+	if( ctx->caching && data != NULL )
+	{
+		cv::Mat frameMat( ctx->processing_height, ctx->processing_width, CV_8UC3, data );
+		const uint64_t hash = DgAcceleratorDHash( frameMat );
+		DgAcceleratorSource &source = sourceGet( ctx, source_id );
+		std::lock_guard< std::mutex > lock( ctx->sourcesMutex );
+		const DgAcceleratorOutput *cached = source.cache ? source.cache->find( hash ) : nullptr;
+		if( cached != nullptr )
+		{
+			ctx->framesCached++;
+			outputReset( ctx->out[ curFrameIndex ] );
+			source.reusedOutput = *cached;
+			return &source.reusedOutput;
+		}
+		ctx->slotHash[ curFrameIndex ] = hash;
+	}
+
+	ctx->diff++;  // Increment # of frames waiting to be processed
+
 	// Frame skip implementation:
 	if( ctx->drop_frames )
 	{
-		if( ctx->diff > FRAME_DIFF_LIMIT )  // if FRAME_DIFF_LIMIT frames behind
+		if( ctx->diff > ctx->frameDiffLimit )  // if frameDiffLimit frames behind
 			goto skip;
 	}
 
 	if( data != NULL )  // Data is a pointer to a cv::Mat.
 	{
-		// Extract the mat
-		cv::Mat frameMat( ctx->processing_height, ctx->processing_width, CV_8UC3, data );
-		// encode this mat into a jpeg buffer vector.
-		std::vector< int > param = { cv::IMWRITE_JPEG_QUALITY, 85 };
-		std::vector< unsigned char > ubuff = {};
-		// Compress the image and store it in the memory buffer that is resized to fit the result.
-		cv::imencode( ".jpeg", frameMat, ubuff, param );
-		// Pass to the model.
-		std::vector< std::vector< char > > frameVect{ std::vector< char >( ubuff.begin(), ubuff.end() ) };
-		// This passes the data buffer and the current frame output object index to work on
-		ctx->model->predict( frameVect, std::to_string( curFrameIndex ) );  // Call the predict function
-		frameMat.release();
+		// The gate compares the next frames with this one only once it is submitted, not when it is dropped above
+		if( gate != nullptr )
+			gate->accept();
+		submit( ctx, data, curFrameIndex, source_id, encoded );
 	}
 	return ctx->out[ curFrameIndex ];
 
@@ -436,7 +1248,338 @@ skip:
 	std::cout << "If this happens too often, lower the incoming framerate of streams and/or the number of streams!\n";
 	ctx->diff--;
 	// Return an empty frame instead
-	return (DgAcceleratorOutput *)calloc( 1, sizeof( DgAcceleratorOutput ) );
+	return &ctx->emptyOutput;
+}
+
+///
+/// \brief Reserves circular buffer slots for the tiles of each frame in tiling mode
+///
+/// Every frame uses as many consecutive slots as the largest tile layout, which is the layout of full frames. This
+/// keeps each group of slots assigned to the same source, so the results read from a group always belong to the
+/// source of the frame. Called when the frame size is known; outstanding frames are completed before resizing.
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] width Width of the frames
+/// \param[in] height Height of the frames
+///
+void DgAcceleratorTilingSet( DgAcceleratorCtx *ctx, int width, int height )
+{
+	const int slotsPerFrame = (int)DgAcceleratorTileLayout( width, height, ctx->processing_width, ctx->processing_height, ctx->tileOverlap ).size();
+	if( slotsPerFrame == ctx->slotsPerFrame )
+		return;
+
+	waitCompletion( ctx );
+	ctx->slotsPerFrame = slotsPerFrame;
+	ctx->ringBufferSize = 2 * ctx->numInputStreams * slotsPerFrame;
+	ctx->frameDiffLimit = std::max( 3 * slotsPerFrame, ctx->ringBufferSize - slotsPerFrame );
+	for( size_t i = ctx->ringBufferSize; i < ctx->out.size(); i++ )
+		delete ctx->out[ i ];
+	const size_t oldSize = ctx->out.size();
+	ctx->out.resize( ctx->ringBufferSize );
+	for( size_t i = oldSize; i < ctx->out.size(); i++ )
+		ctx->out[ i ] = new DgAcceleratorOutput();
+	ctx->slotSource.resize( ctx->ringBufferSize );
+	ctx->slotHash.resize( ctx->ringBufferSize );
+	ctx->slotSequence.resize( ctx->ringBufferSize );
+	ctx->curIndex = 0;
+	std::cout << "Tiling: " << slotsPerFrame << " tiles per frame of " << width << "x" << height << "\n";
+}
+
+///
+/// \brief Process function for the DgAccelerator model in tiling mode
+///
+/// This function splits a frame region into overlapping tiles at processing resolution, using a layout computed once
+/// per region size for each source. Each tile is converted through the given function and submitted to the model, so
+/// the tiles of a frame are inferred concurrently. The results previously received for the slots of the frame are
+/// merged across tiles with class-aware NMS before the slots are reused.
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] width Width of the frame region
+/// \param[in] height Height of the frame region
+/// \param[in] source_id Source ID of the frame
+/// \param[in] convert Function converting a tile of the region to BGR data at processing resolution, returning NULL on failure
+/// \return Returns a pointer to the merged DgAcceleratorOutput instance, or nullptr if a tile failed to convert
+///
+DgAcceleratorOutput *DgAcceleratorProcessTiled(
+	DgAcceleratorCtx *ctx,
+	int width,
+	int height,
+	unsigned int source_id,
+	const std::function< unsigned char *( const DgAcceleratorTile & ) > &convert )
+{
+	// Reserve the slots of the frame first so that the circular buffer keeps going
+	ctx->curIndex %= ctx->ringBufferSize;
+	const int firstSlot = ctx->curIndex;
+	ctx->curIndex += ctx->slotsPerFrame;
+
+	// If an error happens during inference (such as runtime model parameter validation)
+	if( ctx->failed )
+	{
+		throw std::runtime_error( ctx->failReason );
+	}
+
+	DgAcceleratorSource &source = sourceGet( ctx, source_id );
+	if( source.tiledWidth != width || source.tiledHeight != height )
+	{
+		source.tiles = DgAcceleratorTileLayout( width, height, ctx->processing_width, ctx->processing_height, ctx->tileOverlap );
+		source.tiles.resize( std::min< size_t >( source.tiles.size(), ctx->slotsPerFrame ) );
+		source.tiledWidth = width;
+		source.tiledHeight = height;
+	}
+	const int numTiles = (int)source.tiles.size();
+
+	// Merge the latest results of the slots before they are reused
+	DgAcceleratorMergeTiles(
+		source.tiles, &ctx->out[ firstSlot ], width, height, ctx->processing_width, ctx->processing_height, ctx->tileNmsThreshold, source.tiledOutput );
+
+	ctx->diff += numTiles;  // Increment # of frames waiting to be processed
+	if( ctx->drop_frames && ctx->diff > ctx->frameDiffLimit )
+	{
+		// Reach here if the model can't keep up with all the incoming frames
+		std::cout << "Skipping frame due to diff of " << ctx->diff << "\n";
+		std::cout << "If this happens too often, lower the incoming framerate of streams and/or the number of streams!\n";
+		ctx->diff -= numTiles;
+		return &source.tiledOutput;
+	}
+
+	for( int i = 0; i < numTiles; i++ )
+	{
+		unsigned char *data = convert( source.tiles[ i ] );
+		if( data == NULL )
+		{
+			ctx->diff -= numTiles - i;
+			return nullptr;
+		}
+		submit( ctx, data, firstSlot + i, source_id );
+	}
+	return &source.tiledOutput;
+}
+
+///
+/// \brief Secondary mode: checks whether an object needs to be inferred
+///
+/// Tracked objects reuse their results until the re-inference interval has elapsed since they were last submitted.
+/// Untracked objects cannot be matched across frames and always need to be inferred.
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] source_id Source ID of the frame
+/// \param[in] object_id Tracker ID of the object, or index of the object in the frame if untracked
+/// \param[in] tracked Whether the object has a tracker ID
+/// \return Returns true if the crop of the object should be submitted
+///
+bool DgAcceleratorObjectCheck( DgAcceleratorCtx *ctx, unsigned int source_id, uint64_t object_id, bool tracked )
+{
+	std::lock_guard< std::mutex > lock( ctx->sourcesMutex );
+	DgAcceleratorSource &source = ctx->sources[ source_id ];
+	if( !tracked )
+	{
+		source.untrackedObjects[ object_id ] = {};
+		return true;
+	}
+	DgAcceleratorObjectEntry &object = source.objects[ object_id ];
+	object.seenFrame = source.frame;
+	if( object.submitted && source.frame - object.submittedFrame < ctx->reinferInterval )
+	{
+		ctx->objectsCached++;
+		return false;
+	}
+	return true;
+}
+
+///
+/// \brief Secondary mode: submits the crop of an object to the model
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] data Pointer to the BGR data of the crop at processing resolution
+/// \param[in] source_id Source ID of the frame
+/// \param[in] object_id Tracker ID of the object, or index of the object in the frame if untracked
+/// \param[in] tracked Whether the object has a tracker ID
+///
+void DgAcceleratorProcessObject( DgAcceleratorCtx *ctx, unsigned char *data, unsigned int source_id, uint64_t object_id, bool tracked )
+{
+	// If an error happens during inference (such as runtime model parameter validation)
+	if( ctx->failed )
+	{
+		throw std::runtime_error( ctx->failReason );
+	}
+
+	std::vector< std::vector< char > > frameVect = encode( ctx, data );
+	uint64_t request;
+	{
+		std::lock_guard< std::mutex > lock( ctx->sourcesMutex );
+		request = ctx->nextObjectRequest++;
+		ctx->pendingObjects[ request ] = { source_id, object_id, tracked };
+		if( tracked )
+		{
+			DgAcceleratorSource &source = ctx->sources[ source_id ];
+			DgAcceleratorObjectEntry &object = source.objects[ object_id ];
+			object.submitted = true;
+			object.submittedFrame = source.frame;
+		}
+	}
+	ctx->objectsSubmitted++;
+	if( !dispatch( ctx, frameVect, "o" + std::to_string( request ) ) )
+		objectLost( ctx, request );  // Every server is waiting to be reconnected
+}
+
+///
+/// \brief Secondary mode: waits until the results of all submitted object crops are received
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+///
+void DgAcceleratorObjectsWait( DgAcceleratorCtx *ctx )
+{
+	waitCompletion( ctx );
+	if( ctx->failed )
+	{
+		throw std::runtime_error( ctx->failReason );
+	}
+}
+
+///
+/// \brief Secondary mode: gets the latest classification results of an object
+///
+/// Results of untracked objects are only valid for the current frame and are released once read.
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] source_id Source ID of the frame
+/// \param[in] object_id Tracker ID of the object, or index of the object in the frame if untracked
+/// \param[in] tracked Whether the object has a tracker ID
+/// \param[out] classes Array to fill with the classification results
+/// \param[in] maxClasses Capacity of the classes array
+/// \return Number of classification results written
+///
+int DgAcceleratorObjectResults(
+	DgAcceleratorCtx *ctx,
+	unsigned int source_id,
+	uint64_t object_id,
+	bool tracked,
+	DgAcceleratorClassObject *classes,
+	int maxClasses )
+{
+	std::lock_guard< std::mutex > lock( ctx->sourcesMutex );
+	DgAcceleratorSource &source = ctx->sources[ source_id ];
+	auto &objects = tracked ? source.objects : source.untrackedObjects;
+	auto object = objects.find( object_id );
+	if( object == objects.end() )
+		return 0;
+	const int count = std::min( (int)object->second.classes.size(), maxClasses );
+	std::copy( object->second.classes.begin(), object->second.classes.begin() + count, classes );
+	if( !tracked )
+		objects.erase( object );
+	return count;
+}
+
+///
+/// \brief Secondary mode: ends a frame of a source
+///
+/// Tracked objects which were not seen for a whole re-inference interval are forgotten, as they would be inferred
+/// again anyway when they reappear.
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] source_id Source ID of the frame
+///
+void DgAcceleratorObjectsFrameEnd( DgAcceleratorCtx *ctx, unsigned int source_id )
+{
+	std::lock_guard< std::mutex > lock( ctx->sourcesMutex );
+	DgAcceleratorSource &source = ctx->sources[ source_id ];
+	for( auto object = source.objects.begin(); object != source.objects.end(); )
+	{
+		if( source.frame - object->second.seenFrame > ctx->reinferInterval )
+			object = source.objects.erase( object );
+		else
+			++object;
+	}
+	source.frame++;
+}
+
+///
+/// \brief Runs the tracker of a source on the output of one frame
+///
+/// This function advances the tracker of the given source by one frame. If the output holds inference results which
+/// were not consumed yet, the tracks are corrected with its detections; otherwise their boxes are extrapolated. The
+/// tracker for a source is created on first use.
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] source_id Source ID of the frame
+/// \param[in,out] output Output for the frame, marked as consumed by this function
+/// \param[out] tracks Array to fill with the tracked objects
+/// \param[in] maxTracks Capacity of the tracks array
+/// \return Number of tracked objects written
+///
+int DgAcceleratorTrackObjects( DgAcceleratorCtx *ctx, unsigned int source_id, DgAcceleratorOutput *output, DgAcceleratorTrackedObject *tracks, int maxTracks )
+{
+	std::unique_ptr< DgAcceleratorTracker > &tracker = sourceGet( ctx, source_id ).tracker;
+	if( !tracker )  // IDs are unique across the trackers of the process
+		tracker = std::make_unique< DgAcceleratorTracker >( ctx->trackerParams );
+
+	tracker->predict();
+	if( output->inferred )
+	{
+		tracker->update( output->object, output->numObjects );
+		output->inferred = false;
+	}
+	return tracker->get( tracks, maxTracks );
+}
+
+///
+/// \brief Warms the model up by inferring blank frames
+///
+/// The first frames of a model instance pay for the connection and the model load on the server. Warming up moves
+/// this latency out of the stream. Each instance receives the given number of frames, spread by the scheduler.
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \param[in] frames Number of frames per model instance
+///
+void DgAcceleratorWarmUp( DgAcceleratorCtx *ctx, unsigned int frames )
+{
+	cv::Mat blank( ctx->processing_height, ctx->processing_width, CV_8UC3, cv::Scalar( 114, 114, 114 ) );
+	std::vector< std::vector< char > > frameVect = encode( ctx, blank.data );
+	for( size_t i = 0; i < frames * ctx->servers.size(); i++ )
+		dispatch( ctx, frameVect, "w" );
+	waitCompletion( ctx );
+	if( ctx->failed )
+	{
+		throw std::runtime_error( ctx->failReason );
+	}
+}
+
+///
+/// \brief Returns the keypoint topology of a pose model
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance
+/// \return The skeleton, valid for the lifetime of the context; NULL until the first pose was parsed
+///
+const DgAcceleratorSkeleton *DgAcceleratorPoseSkeleton( DgAcceleratorCtx *ctx )
+{
+	return ctx->skeletonReady.load( std::memory_order_acquire ) ? &ctx->skeleton : nullptr;
+}
+
+///
+/// \brief Resolves the label ID of a result
+///
+/// Results only carry label IDs, interned per model by the parser. The string is looked up when metadata is attached.
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance which produced the result
+/// \param[in] labelId Label ID of the result
+/// \return The label, valid for the lifetime of the context
+///
+const char *DgAcceleratorLabel( DgAcceleratorCtx *ctx, uint16_t labelId )
+{
+	return ctx->labels.name( labelId );
+}
+
+///
+/// \brief Gets the upscaler of the segmentation class maps of a source to frame resolution
+///
+/// Upscalers are kept per model and source, so that models of different mask sizes each keep their index tables.
+///
+/// \param[in] ctx Pointer to the DgAcceleratorCtx instance which produced the class maps
+/// \param[in] source_id Source ID of the frames
+/// \return The upscaler, valid for the lifetime of the context
+///
+DgAcceleratorMaskUpscaler &DgAcceleratorSourceMaskUpscaler( DgAcceleratorCtx *ctx, unsigned int source_id )
+{
+	return sourceGet( ctx, source_id ).maskUpscaler;
 }
 
 ///
@@ -450,24 +1593,69 @@ skip:
 void DgAcceleratorCtxDeinit( DgAcceleratorCtx *ctx )
 {
 	std::cout << "\nDeinitializing model, processing " << ctx->diff << " outstanding frames...\n\n\n";
+	// Stop reconnecting failed servers
+	if( ctx->reconnector.joinable() )
+	{
+		{
+			std::lock_guard< std::mutex > lock( ctx->reconnectMutex );
+			ctx->reconnectStop = true;
+		}
+		ctx->reconnectCondition.notify_one();
+		ctx->reconnector.join();
+	}
 	// Process all outstanding frames:
-	ctx->model->waitCompletion();
+	waitCompletion( ctx );
 
 	// Calculate FPS
 	auto end_time = std::chrono::high_resolution_clock::now();
 	auto duration = std::chrono::duration_cast< std::chrono::milliseconds >( end_time - ctx->start_time );
 	std::cout << "Frames processed / duration (FPS) :" << 1000 * ( (long double)ctx->framesProcessed / duration.count() ) << "\n";
+	if( ctx->firstResult )
+	{
+		std::cout << "Time to first result : " << ctx->timeToFirstResult << " ms\n";
+	}
+	if( ctx->motionGating )
+	{
+		const size_t total = std::max< size_t >( 1, ctx->framesSubmitted + ctx->framesGated + ctx->framesCached );
+		std::cout << "Frames inferred / gated by motion : " << ctx->framesSubmitted << " / " << ctx->framesGated << " ("
+				  << 100.0 * ctx->framesSubmitted / total << "% / " << 100.0 * ctx->framesGated / total << "%)\n";
+	}
+	if( ctx->objectsSubmitted + ctx->objectsCached > 0 )
+	{
+		std::cout << "Objects inferred / reused from cache : " << ctx->objectsSubmitted << " / " << ctx->objectsCached << "\n";
+	}
+	if( ctx->caching )
+	{
+		const size_t total = std::max< size_t >( 1, ctx->framesSubmitted + ctx->framesGated + ctx->framesCached );
+		std::cout << "Frames answered from result cache : " << ctx->framesCached << " (" << 100.0 * ctx->framesCached / total << "%)\n";
+	}
+	if( ctx->framesLost > 0 )
+	{
+		std::cout << "Frames / objects left without results by server errors : " << ctx->framesLost << "\n";
+	}
 
 	ctx->framesProcessed = 0;
 	ctx->diff = 0;
 
-	// Reset our model
-	ctx->model.reset();
-	free( ctx );
+	// Report the health and latency of each server
+	if( ctx->servers.size() > 1 )
+	{
+		for( const auto &server : ctx->servers )
+		{
+			std::cout << "Server " << server->address << " : " << server->completed << " / " << server->submitted << " results received, "
+					  << server->errors << " errors, latency mean / max " << server->latencyTotal / std::max< size_t >( 1, server->completed )
+					  << " / " << server->latencyMax << " ms" << ( server->errors > 0 || server->completed < server->submitted ? " (unhealthy)" : "" )
+					  << "\n";
+		}
+	}
+
+	// Reset our models
+	ctx->servers.clear();
 	// Free output objects
 	for( auto &elem : ctx->out )
 	{
 		delete elem;
 		elem = nullptr;
 	}
+	delete ctx;
 }
\ No newline at end of file
@@ -26,53 +26,91 @@
 #ifndef __DGACCELERATOR_LIB__
 #define __DGACCELERATOR_LIB__
 
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
+#include "dgaccelerator_mask.h"
 
-constexpr int DG_MAX_LABEL_SIZE = 128;  //!< Max string size to allocate
-constexpr int MAX_OBJ_PER_FRAME = 35;   //!< Max objects to draw per frame
+
+constexpr int MAX_OBJ_PER_FRAME = 35;          //!< Max objects to draw per frame
+constexpr int MAX_KEYPOINTS_PER_FRAME = 1024;  //!< Max pose keypoints per frame, room for MAX_OBJ_PER_FRAME poses of 29 keypoints
 
 class DgAcceleratorCtx;
+class DgAcceleratorEncodedFrame;
 typedef struct _GstDgAccelerator GstDgAccelerator;  //!< Forward declaration for GstDgAccelerator
 
 /// \brief Result from Object Detection Model
 struct DgAcceleratorObject
 {
-	float left;                       //!< x coordinate of the bounding box
-	float top;                        //!< y coordinate of the bounding box
-	float width;                      //!< Width of the bounding box
-	float height;                     //!< Height of the bounding box
-	char label[ DG_MAX_LABEL_SIZE ];  //!< Label assigned to the detected object
+	float left;        //!< x coordinate of the bounding box
+	float top;         //!< y coordinate of the bounding box
+	float width;       //!< Width of the bounding box
+	float height;      //!< Height of the bounding box
+	float score;       //!< Confidence of the detection
+	int classId;       //!< Class ID of the detected object
+	uint16_t labelId;  //!< ID of the label assigned to the detected object, resolved by DgAcceleratorLabel
+};
+
+/// \brief Object reported by the built-in tracker
+struct DgAcceleratorTrackedObject
+{
+	DgAcceleratorObject object;  //!< Filtered or extrapolated box of the track, with the label, class and confidence of its last detection
+	uint64_t id;                 //!< Stable ID of the track
+};
+
+/// \brief Tile of a frame region inferred separately in tiling mode
+struct DgAcceleratorTile
+{
+	int left;    //!< x coordinate of the tile in the region
+	int top;     //!< y coordinate of the tile in the region
+	int width;   //!< Width of the tile
+	int height;  //!< Height of the tile
+};
+
+/// \brief Model run by a library context
+struct DgAcceleratorModelConfig
+{
+	std::string name;      //!< Full name of the model
+	int width;             //!< Processing width of the model
+	int height;            //!< Processing height of the model
+	double confThreshold;  //!< Output confidence threshold, negative to use the output-conf-threshold property
+};
+
+/// \brief Results from Pose Estimation Model: the keypoints of all poses of a frame, as flat arrays
+struct DgAcceleratorPoses
+{
+	float score[ MAX_OBJ_PER_FRAME ];                //!< Confidence of each pose
+	int first[ MAX_OBJ_PER_FRAME + 1 ];              //!< Keypoints of pose i are at indices [first[i], first[i+1])
+	float x[ MAX_KEYPOINTS_PER_FRAME ];              //!< x coordinates of the keypoints
+	float y[ MAX_KEYPOINTS_PER_FRAME ];              //!< y coordinates of the keypoints
+	float keypointScore[ MAX_KEYPOINTS_PER_FRAME ];  //!< Confidence of the keypoints, the pose confidence if the model reports none
+	int classId[ MAX_KEYPOINTS_PER_FRAME ];          //!< Class IDs of the keypoints
 };
 
-/// \brief Result from Pose Estimation Model
-struct DgAcceleratorPose
+/// \brief Keypoint topology of a pose model, identical for all of its poses
+struct DgAcceleratorSkeleton
 {
-	/// \brief A Landmark. Inference produces a set of these, together they define the pose
-	struct Landmark
-	{
-		std::pair< double, double > point;  //!< Coordinate of the landmark. [0] = x, [1] = y
-		std::vector< int > connection;      //!< Indices of landmarks this one connects to
-		char label[ DG_MAX_LABEL_SIZE ];    //!< Label of this landmark
-		int landmark_class;                 //!< Index of this landmark
-	};
-	std::vector< Landmark > landmarks;      //!< Vector of landmarks defining the pose
+	std::vector< std::pair< int, int > > edges;  //!< Connected keypoint indices within a pose, each undirected connection once
+	std::vector< uint16_t > labelIds;            //!< Label IDs of the keypoints by index within a pose, resolved by DgAcceleratorLabel
 };
 
 /// \brief Result from Classification Model
 struct DgAcceleratorClassObject
 {
-	double score;                     //!< Probability of classified object
-	char label[ DG_MAX_LABEL_SIZE ];  //!< Label for the object
+	double score;      //!< Probability of classified object
+	int classId;       //!< Class ID of the result, -1 if the model does not report one
+	uint16_t labelId;  //!< ID of the label for the object, resolved by DgAcceleratorLabel
 };
 
 /// \brief Result from Segmentation Model
 struct DgAcceleratorSegmentation
 {
-	std::vector< int > class_map;  //!< Array for 2D pixel class map. Pixel (x,y) is at class_map[y*width+x]
-	size_t mask_width;             //!< Width of the segmentation mask
-	size_t mask_height;            //!< Height of the segmentation mask
+	DgAcceleratorMaskBuffer class_map;  //!< Pooled 2D pixel class map shared by reference, empty if none. Pixel (x,y) is at index y*width+x
+	size_t element_size;                //!< Size of the class IDs of class_map in bytes: 1 (uint8) or 4 (int32)
+	size_t mask_width;                  //!< Width of the segmentation mask
+	size_t mask_height;                 //!< Height of the segmentation mask
 };
 
 /// \brief Output data for 1 frame returned after processing
@@ -82,20 +120,65 @@ struct DgAcceleratorOutput
 	int numObjects;                                   //!< Number of detected objects
 	DgAcceleratorObject object[ MAX_OBJ_PER_FRAME ];  //!< Object array. Allocates room for MAX_OBJ_PER_FRAME objects
 	// Pose Estimation models:
-	int numPoses;                                 //!< Number of detected poses
-	DgAcceleratorPose pose[ MAX_OBJ_PER_FRAME ];  //!< Poses array. Allocates room for MAX_OBJ_PER_FRAME poses.
+	int numPoses;              //!< Number of detected poses
+	DgAcceleratorPoses poses;  //!< Keypoints of the poses. Allocates room for MAX_OBJ_PER_FRAME poses.
 	// Classification models:
 	int k;                                                           //!< Number of classified objects
 	DgAcceleratorClassObject classifiedObject[ MAX_OBJ_PER_FRAME ];  //!< Classified object array. Allocates room for MAX_OBJ_PER_FRAME objects.
 	// Segmentation Models:
 	DgAcceleratorSegmentation segMap;  //!< Segmentation map for a frame
+	bool inferred;                     //!< Set when new inference results were written, cleared once the tracker consumed them
 };
 
 // Initialize library
 DgAcceleratorCtx *DgAcceleratorCtxInit( GstDgAccelerator *dgaccelerator );
 
-// Process output
-DgAcceleratorOutput *DgAcceleratorProcess( DgAcceleratorCtx *ctx, unsigned char *data );
+// Initialize library for one of several models hosted by the element
+DgAcceleratorCtx *DgAcceleratorCtxInit( GstDgAccelerator *dgaccelerator, const DgAcceleratorModelConfig &config );
+
+// Process output, sharing the encoded frame through encoded when given
+DgAcceleratorOutput *DgAcceleratorProcess( DgAcceleratorCtx *ctx, unsigned char *data, unsigned int source_id, DgAcceleratorEncodedFrame *encoded = nullptr );
+
+// Tiling mode: reserve ring buffer slots for the tiles of frames of the given size
+void DgAcceleratorTilingSet( DgAcceleratorCtx *ctx, int width, int height );
+
+// Tiling mode: process the tiles of a frame region, converting each one to processing resolution through convert
+DgAcceleratorOutput *DgAcceleratorProcessTiled(
+	DgAcceleratorCtx *ctx,
+	int width,
+	int height,
+	unsigned int source_id,
+	const std::function< unsigned char *( const DgAcceleratorTile & ) > &convert );
+
+// Secondary mode: check whether an object needs to be inferred or can reuse its results
+bool DgAcceleratorObjectCheck( DgAcceleratorCtx *ctx, unsigned int source_id, uint64_t object_id, bool tracked );
+
+// Secondary mode: submit the crop of an object
+void DgAcceleratorProcessObject( DgAcceleratorCtx *ctx, unsigned char *data, unsigned int source_id, uint64_t object_id, bool tracked );
+
+// Secondary mode: wait for the results of all submitted object crops
+void DgAcceleratorObjectsWait( DgAcceleratorCtx *ctx );
+
+// Secondary mode: get the latest classification results of an object
+int DgAcceleratorObjectResults( DgAcceleratorCtx *ctx, unsigned int source_id, uint64_t object_id, bool tracked, DgAcceleratorClassObject *classes, int maxClasses );
+
+// Secondary mode: end a frame of a source, forgetting objects which left
+void DgAcceleratorObjectsFrameEnd( DgAcceleratorCtx *ctx, unsigned int source_id );
+
+// Track objects of one source, extrapolating boxes on frames without new results
+int DgAcceleratorTrackObjects( DgAcceleratorCtx *ctx, unsigned int source_id, DgAcceleratorOutput *output, DgAcceleratorTrackedObject *tracks, int maxTracks );
+
+// Submit blank frames to every model instance and wait for their results, before real frames are processed
+void DgAcceleratorWarmUp( DgAcceleratorCtx *ctx, unsigned int frames );
+
+// Get the skeleton of a pose model, NULL until the first pose was parsed
+const DgAcceleratorSkeleton *DgAcceleratorPoseSkeleton( DgAcceleratorCtx *ctx );
+
+// Resolve the label ID of a result of the context
+const char *DgAcceleratorLabel( DgAcceleratorCtx *ctx, uint16_t labelId );
+
+// Get the upscaler of the segmentation class maps of a source to frame resolution
+DgAcceleratorMaskUpscaler &DgAcceleratorSourceMaskUpscaler( DgAcceleratorCtx *ctx, unsigned int source_id );
 
 // Deinitialize our library context
 void DgAcceleratorCtxDeinit( DgAcceleratorCtx *ctx );
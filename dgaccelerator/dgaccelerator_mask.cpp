@@ -0,0 +1,267 @@
+//////////////////////////////////////////////////////////////////////
+///  \file  dgaccelerator_mask.cpp
+///  \brief Pooled segmentation mask buffers implementation
+///
+///  Copyright 2023 DeGirum Corporation
+///
+///  Permission is hereby granted, free of charge, to any person obtaining a
+///  copy of this software and associated documentation files (the "Software"),
+///  to deal in the Software without restriction, including without limitation
+///  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///  and/or sell copies of the Software, and to permit persons to whom the
+///  Software is furnished to do so, subject to the following conditions:
+///
+///  The above copyright notice and this permission notice shall be included in
+///  all copies or substantial portions of the Software.
+///
+///  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+///  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+///  DEALINGS IN THE SOFTWARE.
+///
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "dgaccelerator_mask.h"
+
+constexpr size_t MASK_POOL_MAX_FREE = 16;  //!< Maximum number of free buffers kept per size
+
+/// \brief Free mask buffers by size
+struct DgAcceleratorMaskPool
+{
+	std::mutex mutex;                                   //!< Guards free and stats
+	std::map< size_t, std::vector< uint8_t * > > free;  //!< Free buffers, by size
+	DgAcceleratorMaskPoolStats stats = {};              //!< Pool counters
+};
+
+///
+/// \brief Gets the process-wide mask pool
+/// \return The pool, allocated on first use and never destroyed
+///
+static DgAcceleratorMaskPool &maskPool()
+{
+	static DgAcceleratorMaskPool *pool = new DgAcceleratorMaskPool();
+	return *pool;
+}
+
+///
+/// \brief Returns a buffer to the pool, or frees it if enough buffers of its size are already pooled
+/// \param[in] buffer The buffer
+/// \param[in] bytes Size of the buffer
+///
+static void maskRelease( uint8_t *buffer, size_t bytes )
+{
+	DgAcceleratorMaskPool &pool = maskPool();
+	{
+		std::lock_guard< std::mutex > lock( pool.mutex );
+		std::vector< uint8_t * > &free = pool.free[ bytes ];
+		if( free.size() < MASK_POOL_MAX_FREE )
+		{
+			free.push_back( buffer );
+			return;
+		}
+	}
+	delete[] buffer;
+}
+
+///
+/// \brief Counts class map bytes written into the pool counters
+/// \param[in] bytes Number of bytes written
+///
+static void maskWritten( size_t bytes )
+{
+	DgAcceleratorMaskPool &pool = maskPool();
+	std::lock_guard< std::mutex > lock( pool.mutex );
+	pool.stats.bytesWritten += bytes;
+}
+
+DgAcceleratorMaskBuffer DgAcceleratorMaskAcquire( size_t bytes )
+{
+	DgAcceleratorMaskPool &pool = maskPool();
+	uint8_t *buffer = nullptr;
+	{
+		std::lock_guard< std::mutex > lock( pool.mutex );
+		pool.stats.acquired++;
+		auto it = pool.free.find( bytes );
+		if( it != pool.free.end() && !it->second.empty() )
+		{
+			buffer = it->second.back();
+			it->second.pop_back();
+		}
+		else
+		{
+			pool.stats.allocated++;
+			pool.stats.bytesAllocated += bytes;
+		}
+	}
+	if( !buffer )
+		buffer = new uint8_t[ bytes ];
+	return DgAcceleratorMaskBuffer( buffer, [ bytes ]( uint8_t *p ) { maskRelease( p, bytes ); } );
+}
+
+DgAcceleratorMaskBuffer DgAcceleratorMaskConvert( const uint8_t *src, size_t count, size_t srcElementSize, size_t dstElementSize )
+{
+	DgAcceleratorMaskBuffer buffer = DgAcceleratorMaskAcquire( count * dstElementSize );
+	if( srcElementSize == dstElementSize )
+		std::memcpy( buffer.get(), src, count * dstElementSize );
+	else if( dstElementSize == 1 )
+		std::copy( (const int32_t *)src, (const int32_t *)src + count, buffer.get() );
+	else
+		std::copy( src, src + count, (int32_t *)buffer.get() );
+	maskWritten( count * dstElementSize );
+	return buffer;
+}
+
+DgAcceleratorMaskPoolStats DgAcceleratorMaskPoolGetStats()
+{
+	DgAcceleratorMaskPool &pool = maskPool();
+	std::lock_guard< std::mutex > lock( pool.mutex );
+	return pool.stats;
+}
+
+void DgAcceleratorMaskStats( const uint8_t *classMap, int width, int height, std::vector< DgAcceleratorClassStats > &stats )
+{
+	DgAcceleratorClassStats byClass[ 256 ];
+	for( int c = 0; c < 256; c++ )
+		byClass[ c ] = { c, 0, 0, 0, width, height, -1, -1 };
+
+	for( int y = 0; y < height; y++ )
+	{
+		const uint8_t *row = classMap + (size_t)y * width;
+		int x = 0;
+		while( x < width )
+		{
+			const uint8_t c = row[ x ];
+			const uint64_t pattern = 0x0101010101010101ull * c;
+			int end = x + 1;
+			// Skip 8 pixels at a time while the whole word matches the class of the run
+			while( end + 8 <= width )
+			{
+				uint64_t word;
+				std::memcpy( &word, row + end, sizeof( word ) );
+				if( word != pattern )
+					break;
+				end += 8;
+			}
+			while( end < width && row[ end ] == c )
+				end++;
+
+			DgAcceleratorClassStats &st = byClass[ c ];
+			const uint64_t n = end - x;
+			st.area += n;
+			st.sumX += n * ( x + end - 1 ) / 2;
+			st.sumY += n * y;
+			st.left = std::min( st.left, x );
+			st.right = std::max( st.right, end - 1 );
+			st.top = std::min( st.top, y );
+			st.bottom = y;
+			x = end;
+		}
+	}
+
+	stats.clear();
+	for( int c = 0; c < 256; c++ )
+		if( byClass[ c ].area )
+			stats.push_back( byClass[ c ] );
+}
+
+void DgAcceleratorMaskPolygons( const uint8_t *classMap, int width, int height, double tolerance, std::vector< DgAcceleratorPolygon > &polygons )
+{
+	std::vector< DgAcceleratorClassStats > stats;
+	DgAcceleratorMaskStats( classMap, width, height, stats );
+
+	const cv::Mat map( height, width, CV_8U, const_cast< uint8_t * >( classMap ) );
+	cv::Mat binary;
+	std::vector< std::vector< cv::Point > > contours;
+	std::vector< cv::Point > simplified;
+	polygons.clear();
+	for( const DgAcceleratorClassStats &st : stats )
+	{
+		if( st.classId == 0 )
+			continue;
+		const cv::Rect box( st.left, st.top, st.right - st.left + 1, st.bottom - st.top + 1 );
+		cv::compare( map( box ), st.classId, binary, cv::CMP_EQ );
+		cv::findContours( binary, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE, cv::Point( box.x, box.y ) );
+		for( const auto &contour : contours )
+		{
+			cv::approxPolyDP( contour, simplified, tolerance, true );
+			if( simplified.size() >= 3 )
+				polygons.push_back( { st.classId, simplified } );
+		}
+	}
+}
+
+///
+/// \brief Computes the nearest neighbour source index of each destination index, like cv::resize with INTER_NEAREST
+/// \param[in] srcSize Source size
+/// \param[in] dstSize Destination size
+/// \param[out] index Source index of each destination index
+///
+static void nearestIndex( int srcSize, int dstSize, std::vector< int > &index )
+{
+	const double scale = 1. / ( (double)dstSize / srcSize );
+	index.resize( dstSize );
+	for( int d = 0; d < dstSize; d++ )
+		index[ d ] = std::min( (int)std::floor( d * scale ), srcSize - 1 );
+}
+
+void DgAcceleratorMaskUpscaler::upscale( const uint8_t *src, int srcWidth, int srcHeight, int32_t *dst, size_t dstStride, int dstWidth, int dstHeight )
+{
+	if( srcWidth != m_srcWidth || srcHeight != m_srcHeight || dstWidth != m_dstWidth || dstHeight != m_dstHeight )
+	{
+		nearestIndex( srcWidth, dstWidth, m_xIndex );
+		nearestIndex( srcHeight, dstHeight, m_yIndex );
+		// The source column index never decreases, so each source column maps to one run of destination columns
+		m_xRunStart.assign( srcWidth + 1, dstWidth );
+		for( int x = 0, s = 0; x < dstWidth; x++ )
+			for( ; s <= m_xIndex[ x ]; s++ )
+				m_xRunStart[ s ] = x;
+		m_xRunMax = 0;
+		for( int s = 0; s < srcWidth; s++ )
+			m_xRunMax = std::max( m_xRunMax, m_xRunStart[ s + 1 ] - m_xRunStart[ s ] );
+		m_srcWidth = srcWidth;
+		m_srcHeight = srcHeight;
+		m_dstWidth = dstWidth;
+		m_dstHeight = dstHeight;
+	}
+
+	const int *xIndex = m_xIndex.data();
+	const int *runStart = m_xRunStart.data();
+	for( int y = 0; y < dstHeight; y++ )
+	{
+		int32_t *row = dst + y * dstStride;
+		if( y > 0 && m_yIndex[ y ] == m_yIndex[ y - 1 ] )
+		{
+			std::memcpy( row, row - dstStride, dstWidth * sizeof( int32_t ) );
+			continue;
+		}
+		const uint8_t *srcRow = src + (size_t)m_yIndex[ y ] * srcWidth;
+		if( m_xRunMax <= 4 )
+		{
+			// Store 4 pixels per source column: the run is at most 4 pixels long and the following runs overwrite the rest
+			int s = 0;
+			for( ; s < srcWidth && runStart[ s ] + 4 <= dstWidth; s++ )
+			{
+				const int32_t v = srcRow[ s ];
+				const int32_t quad[ 4 ] = { v, v, v, v };
+				std::memcpy( row + runStart[ s ], quad, sizeof( quad ) );
+			}
+			for( ; s < srcWidth; s++ )
+				for( int x = runStart[ s ]; x < runStart[ s + 1 ]; x++ )
+					row[ x ] = srcRow[ s ];
+		}
+		else
+			for( int x = 0; x < dstWidth; x++ )
+				row[ x ] = srcRow[ xIndex[ x ] ];
+	}
+	maskWritten( (size_t)dstWidth * dstHeight * sizeof( int32_t ) );
+}
@@ -0,0 +1,156 @@
+//////////////////////////////////////////////////////////////////////
+///  \file  dgaccelerator_mask.h
+///  \brief Pooled segmentation mask buffers header file
+///
+///  Copyright 2023 DeGirum Corporation
+///
+///  Permission is hereby granted, free of charge, to any person obtaining a
+///  copy of this software and associated documentation files (the "Software"),
+///  to deal in the Software without restriction, including without limitation
+///  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///  and/or sell copies of the Software, and to permit persons to whom the
+///  Software is furnished to do so, subject to the following conditions:
+///
+///  The above copyright notice and this permission notice shall be included in
+///  all copies or substantial portions of the Software.
+///
+///  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+///  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+///  DEALINGS IN THE SOFTWARE.
+///
+
+
+#ifndef __DGACCELERATOR_MASK__
+#define __DGACCELERATOR_MASK__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// OpenCV
+#include "opencv2/imgproc/imgproc.hpp"
+
+/// \brief Refcounted segmentation mask buffer, returned to the mask pool when its last reference is dropped
+using DgAcceleratorMaskBuffer = std::shared_ptr< uint8_t >;
+
+/// \brief Mask pool counters
+struct DgAcceleratorMaskPoolStats
+{
+	uint64_t acquired;        //!< Number of buffers handed out
+	uint64_t allocated;       //!< Number of buffers allocated because no free buffer of the size was pooled
+	uint64_t bytesAllocated;  //!< Total size of the allocated buffers
+	uint64_t bytesWritten;    //!< Class map bytes written by DgAcceleratorMaskConvert and DgAcceleratorMaskUpscaler
+};
+
+///
+/// \brief Gets a mask buffer from the process-wide pool
+///
+/// Segmentation class maps are written once into a pooled buffer, which then travels by reference: output copies,
+/// cached results and segmentation metadata copies share it instead of copying the map. Free buffers are kept by size,
+/// so a stream of same-sized masks stops allocating after its first frames. The pool is never destroyed, so metadata
+/// released late by downstream elements still returns its buffer safely.
+///
+/// \param[in] bytes Size of the buffer
+/// \return The buffer, with undefined contents
+///
+DgAcceleratorMaskBuffer DgAcceleratorMaskAcquire( size_t bytes );
+
+///
+/// \brief Copies a class map into a pooled buffer, converting its class IDs to the given size
+/// \param[in] src Class map of count class IDs
+/// \param[in] count Number of class IDs
+/// \param[in] srcElementSize Size of the source class IDs in bytes: 1 (uint8) or 4 (int32)
+/// \param[in] dstElementSize Size of the returned class IDs in bytes: 1 (uint8) or 4 (int32)
+/// \return The class map buffer
+///
+DgAcceleratorMaskBuffer DgAcceleratorMaskConvert( const uint8_t *src, size_t count, size_t srcElementSize, size_t dstElementSize );
+
+// Gets the mask pool counters
+DgAcceleratorMaskPoolStats DgAcceleratorMaskPoolGetStats();
+
+/// \brief Statistics of the pixels of one class in a class map
+struct DgAcceleratorClassStats
+{
+	int classId;    //!< Class ID
+	uint64_t area;  //!< Number of pixels of the class
+	uint64_t sumX;  //!< Sum of the x coordinates of the pixels
+	uint64_t sumY;  //!< Sum of the y coordinates of the pixels
+	int left;       //!< Smallest x coordinate of the pixels
+	int top;        //!< Smallest y coordinate of the pixels
+	int right;      //!< Largest x coordinate of the pixels
+	int bottom;     //!< Largest y coordinate of the pixels
+};
+
+///
+/// \brief Computes the area, coordinate sums and bounding box of every class present in a class map, in one pass
+///
+/// Class maps are made of long runs of the same class, so rows are scanned run by run: run ends are found 8 pixels at
+/// a time by comparing 64-bit words against the class of the run, and each run updates the statistics of its class
+/// once.
+///
+/// \param[in] classMap uint8 class map of width * height pixels
+/// \param[in] width Width of the class map
+/// \param[in] height Height of the class map
+/// \param[out] stats Statistics of the classes present in the map, by increasing class ID
+///
+void DgAcceleratorMaskStats( const uint8_t *classMap, int width, int height, std::vector< DgAcceleratorClassStats > &stats );
+
+/// \brief Closed polygon outlining a region of one class of a class map
+struct DgAcceleratorPolygon
+{
+	int classId;                      //!< Class ID
+	std::vector< cv::Point > points;  //!< Vertices in class map coordinates
+};
+
+///
+/// \brief Extracts the simplified outer contours of the regions of every class of a class map but class 0 (background)
+///
+/// Each class is only scanned within its bounding box, found by DgAcceleratorMaskStats. Contours are simplified with
+/// the Douglas-Peucker algorithm, regions too small to give a polygon of at least 3 vertices are dropped.
+///
+/// \param[in] classMap uint8 class map of width * height pixels
+/// \param[in] width Width of the class map
+/// \param[in] height Height of the class map
+/// \param[in] tolerance Maximum distance between a contour and its simplified polygon, in class map pixels
+/// \param[out] polygons Polygons of the regions, by increasing class ID
+///
+void DgAcceleratorMaskPolygons( const uint8_t *classMap, int width, int height, double tolerance, std::vector< DgAcceleratorPolygon > &polygons );
+
+///
+/// \brief Nearest neighbour upscaler of uint8 class maps into int32 maps, with cached index tables
+///
+/// The source column and row of every destination column and row are computed once per (mask size, destination
+/// size) pair, with the same rounding as cv::resize with INTER_NEAREST. Destination rows are then filled by a table
+/// lookup per pixel, and rows mapping to the same source row as the previous one (most rows when upscaling) are
+/// replicated with a plain memory copy.
+///
+class DgAcceleratorMaskUpscaler
+{
+public:
+	/// \brief Upscales a class map into a region of an int32 map
+	/// \param[in] src uint8 class map of srcWidth * srcHeight pixels
+	/// \param[in] srcWidth Width of the class map
+	/// \param[in] srcHeight Height of the class map
+	/// \param[out] dst First pixel of the destination region
+	/// \param[in] dstStride Number of pixels between the starts of two destination rows
+	/// \param[in] dstWidth Width of the destination region
+	/// \param[in] dstHeight Height of the destination region
+	void upscale( const uint8_t *src, int srcWidth, int srcHeight, int32_t *dst, size_t dstStride, int dstWidth, int dstHeight );
+
+private:
+	int m_srcWidth = 0;              //!< Mask width of the index tables
+	int m_srcHeight = 0;             //!< Mask height of the index tables
+	int m_dstWidth = 0;              //!< Destination width of the index tables
+	int m_dstHeight = 0;             //!< Destination height of the index tables
+	std::vector< int > m_xIndex;     //!< Source column of each destination column
+	std::vector< int > m_yIndex;     //!< Source row of each destination row
+	std::vector< int > m_xRunStart;  //!< First destination column of each source column, and dstWidth
+	int m_xRunMax = 0;               //!< Longest run of destination columns of one source column
+};
+
+#endif
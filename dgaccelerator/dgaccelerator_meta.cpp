@@ -0,0 +1,199 @@
+//////////////////////////////////////////////////////////////////////
+///  \file  dgaccelerator_meta.cpp
+///  \brief GstMeta sharing converted frames between dgaccelerator elements implementation
+///
+///  Copyright 2023 DeGirum Corporation
+///
+///  Permission is hereby granted, free of charge, to any person obtaining a
+///  copy of this software and associated documentation files (the "Software"),
+///  to deal in the Software without restriction, including without limitation
+///  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///  and/or sell copies of the Software, and to permit persons to whom the
+///  Software is furnished to do so, subject to the following conditions:
+///
+///  The above copyright notice and this permission notice shall be included in
+///  all copies or substantial portions of the Software.
+///
+///  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+///  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+///  DEALINGS IN THE SOFTWARE.
+///
+
+#include "dgaccelerator_meta.h"
+
+///
+/// \brief Initializes the meta when it is added to a buffer
+/// \param[in] meta The meta
+/// \param[in] params Unused
+/// \param[in] buffer The buffer
+/// \return TRUE
+///
+static gboolean frame_meta_init( GstMeta *meta, gpointer params, GstBuffer *buffer )
+{
+	GstDgAcceleratorFrameMeta *frame_meta = (GstDgAcceleratorFrameMeta *)meta;
+	frame_meta->width = 0;
+	frame_meta->height = 0;
+	frame_meta->frames = new std::vector< std::shared_ptr< DgAcceleratorSharedFrame > >();
+	return TRUE;
+}
+
+///
+/// \brief Releases the references of the meta to its frames
+/// \param[in] meta The meta
+/// \param[in] buffer The buffer
+///
+static void frame_meta_free( GstMeta *meta, GstBuffer *buffer )
+{
+	GstDgAcceleratorFrameMeta *frame_meta = (GstDgAcceleratorFrameMeta *)meta;
+	delete frame_meta->frames;
+	frame_meta->frames = NULL;
+}
+
+///
+/// \brief Copies the meta to a copy of its buffer, sharing the frames
+///
+/// Other transformations (such as scaling) invalidate the frames, so the meta is only kept on plain copies.
+///
+/// \param[in] dest The destination buffer
+/// \param[in] meta The meta
+/// \param[in] buffer The source buffer
+/// \param[in] type The type of transformation
+/// \param[in] data Transformation data
+/// \return Returns TRUE if the meta was copied, FALSE otherwise
+///
+static gboolean frame_meta_transform( GstBuffer *dest, GstMeta *meta, GstBuffer *buffer, GQuark type, gpointer data )
+{
+	if( !GST_META_TRANSFORM_IS_COPY( type ) )
+		return FALSE;
+	GstDgAcceleratorFrameMeta *frame_meta = (GstDgAcceleratorFrameMeta *)meta;
+	GstDgAcceleratorFrameMeta *dest_meta = gst_dgaccelerator_frame_meta_get( dest, frame_meta->width, frame_meta->height, TRUE );
+	*dest_meta->frames = *frame_meta->frames;
+	return TRUE;
+}
+
+///
+/// \brief Registers and gets the API type of the meta
+///
+/// The meta is tagged as depending on the video size, orientation and colorspace, so elements converting frames drop it.
+///
+/// \return The API type
+///
+GType gst_dgaccelerator_frame_meta_api_get_type( void )
+{
+	static const gchar *tags[] = {
+		GST_META_TAG_VIDEO_STR, GST_META_TAG_VIDEO_SIZE_STR, GST_META_TAG_VIDEO_ORIENTATION_STR, GST_META_TAG_VIDEO_COLORSPACE_STR, NULL
+	};
+	static const GType type = gst_meta_api_type_register( "GstDgAcceleratorFrameMetaAPI", tags );
+	return type;
+}
+
+///
+/// \brief Registers and gets the implementation of the meta
+/// \return The meta info
+///
+const GstMetaInfo *gst_dgaccelerator_frame_meta_get_info( void )
+{
+	static const GstMetaInfo *info = gst_meta_register(
+		gst_dgaccelerator_frame_meta_api_get_type(),
+		"GstDgAcceleratorFrameMeta",
+		sizeof( GstDgAcceleratorFrameMeta ),
+		frame_meta_init,
+		frame_meta_free,
+		frame_meta_transform );
+	return info;
+}
+
+///
+/// \brief Gets the meta holding frames of the given processing resolution
+///
+/// A buffer holds one meta per processing resolution of the dgaccelerator elements it went through.
+///
+/// \param[in] buffer The buffer, must be writable if add is set
+/// \param[in] width Processing width
+/// \param[in] height Processing height
+/// \param[in] add Whether to add the meta when the buffer has none for this resolution
+/// \return The meta, or NULL if there is none and add is not set
+///
+GstDgAcceleratorFrameMeta *gst_dgaccelerator_frame_meta_get( GstBuffer *buffer, gint width, gint height, gboolean add )
+{
+	gpointer state = NULL;
+	GstMeta *meta;
+	while( ( meta = gst_buffer_iterate_meta_filtered( buffer, &state, gst_dgaccelerator_frame_meta_api_get_type() ) ) != NULL )
+	{
+		GstDgAcceleratorFrameMeta *frame_meta = (GstDgAcceleratorFrameMeta *)meta;
+		if( frame_meta->width == width && frame_meta->height == height )
+			return frame_meta;
+	}
+	if( !add )
+		return NULL;
+
+	GstDgAcceleratorFrameMeta *frame_meta = (GstDgAcceleratorFrameMeta *)gst_buffer_add_meta( buffer, gst_dgaccelerator_frame_meta_get_info(), NULL );
+	frame_meta->width = width;
+	frame_meta->height = height;
+	return frame_meta;
+}
+
+///
+/// \brief Gets the frame converted from a region of the frame at a batch index
+///
+/// \param[in] meta The meta
+/// \param[in] batch_id Index of the frame in the batch
+/// \param[in] left x coordinate of the region
+/// \param[in] top y coordinate of the region
+/// \param[in] width Width of the region
+/// \param[in] height Height of the region
+/// \return The frame, or NULL if the frame was not converted or was converted from another region
+///
+std::shared_ptr< DgAcceleratorSharedFrame > gst_dgaccelerator_frame_meta_lookup(
+	GstDgAcceleratorFrameMeta *meta,
+	guint batch_id,
+	float left,
+	float top,
+	float width,
+	float height )
+{
+	if( batch_id >= meta->frames->size() )
+		return nullptr;
+	const std::shared_ptr< DgAcceleratorSharedFrame > &frame = ( *meta->frames )[ batch_id ];
+	if( !frame || frame->left != left || frame->top != top || frame->width != width || frame->height != height )
+		return nullptr;
+	return frame;
+}
+
+///
+/// \brief Gets the encoding of the frame at the given size and format, encoding it if no model did yet
+///
+/// The lock is held while encoding, so models of elements in other branches asking for the same encoding wait for it
+/// instead of encoding the frame again.
+///
+/// \param[in] width Width of the encoded frame
+/// \param[in] height Height of the encoded frame
+/// \param[in] format Format of the encoding, including the encoder settings which change its output
+/// \param[in] encode Function encoding the frame, called at most once per size and format
+/// \return The encoded frame
+///
+const DgAcceleratorEncodedFrame::Data &DgAcceleratorEncodedFrame::get( int width, int height, const std::string &format, const std::function< Data() > &encode )
+{
+	std::lock_guard< std::mutex > lock( m_mutex );
+	for( const Entry &entry : m_entries )
+	{
+		if( entry.width == width && entry.height == height && entry.format == format )
+			return entry.data;
+	}
+	m_entries.push_back( { width, height, format, encode() } );
+	return m_entries.back().data;
+}
+
+///
+/// \brief Gets the number of encodings made
+/// \return Number of distinct sizes and formats the frame was encoded at
+///
+size_t DgAcceleratorEncodedFrame::size() const
+{
+	std::lock_guard< std::mutex > lock( m_mutex );
+	return m_entries.size();
+}
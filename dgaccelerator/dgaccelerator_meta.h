@@ -0,0 +1,225 @@
+//////////////////////////////////////////////////////////////////////
+///  \file  dgaccelerator_meta.h
+///  \brief GstMeta sharing converted frames between dgaccelerator elements header file
+///
+///  Copyright 2023 DeGirum Corporation
+///
+///  Permission is hereby granted, free of charge, to any person obtaining a
+///  copy of this software and associated documentation files (the "Software"),
+///  to deal in the Software without restriction, including without limitation
+///  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///  and/or sell copies of the Software, and to permit persons to whom the
+///  Software is furnished to do so, subject to the following conditions:
+///
+///  The above copyright notice and this permission notice shall be included in
+///  all copies or substantial portions of the Software.
+///
+///  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+///  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+///  DEALINGS IN THE SOFTWARE.
+///
+
+#ifndef __DGACCELERATOR_META__
+#define __DGACCELERATOR_META__
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// GStreamer
+#include <gst/video/video.h>
+
+// OpenCV
+#include "opencv2/imgproc/imgproc.hpp"
+
+///
+/// \brief Model input encodings of a frame, shared between the models and elements inferring it
+///
+/// Each encoding is made once, by the first model asking for its frame size and format, and is never modified
+/// afterwards, so the returned references stay valid and can be read without holding the lock.
+///
+class DgAcceleratorEncodedFrame
+{
+public:
+	/// \brief Model input vector of an encoded frame
+	using Data = std::vector< std::vector< char > >;
+
+	/// \brief Gets the encoding of the frame at the given size and format, encoding it if no model did yet
+	/// \param[in] width Width of the encoded frame
+	/// \param[in] height Height of the encoded frame
+	/// \param[in] format Format of the encoding, including the encoder settings which change its output
+	/// \param[in] encode Function encoding the frame, called at most once per size and format
+	/// \return The encoded frame
+	const Data &get( int width, int height, const std::string &format, const std::function< Data() > &encode );
+
+	/// \brief Gets the number of encodings made
+	/// \return Number of distinct sizes and formats the frame was encoded at
+	size_t size() const;
+
+private:
+	/// \brief Encoding of the frame at one size and format
+	struct Entry
+	{
+		int width;           //!< Width of the encoded frame
+		int height;          //!< Height of the encoded frame
+		std::string format;  //!< Format of the encoding
+		Data data;           //!< Encoded frame
+	};
+
+	mutable std::mutex m_mutex;     //!< Guards the encodings against models of other elements
+	std::deque< Entry > m_entries;  //!< Encodings, which keep their address when more are added
+};
+
+/// \brief Frame of a batch converted to processing resolution, shared between dgaccelerator elements
+struct DgAcceleratorSharedFrame
+{
+	float left;                         //!< x coordinate of the region of the batched frame which was converted
+	float top;                          //!< y coordinate of the converted region
+	float width;                        //!< Width of the converted region
+	float height;                       //!< Height of the converted region
+	cv::Mat bgr;                        //!< BGR data of the region at processing resolution
+	DgAcceleratorEncodedFrame encoded;  //!< Model input encodings of bgr and of its resized copies
+};
+
+///
+/// \brief GstMeta carrying the frames of a batch converted to one processing resolution
+///
+/// Frames are held by shared pointers, so copying the meta along with its buffer does not copy frame data.
+///
+struct GstDgAcceleratorFrameMeta
+{
+	GstMeta meta;                                                        //!< GstMeta boilerplate
+	gint width;                                                          //!< Processing width of the frames
+	gint height;                                                         //!< Processing height of the frames
+	std::vector< std::shared_ptr< DgAcceleratorSharedFrame > > *frames;  //!< Converted frames by index in the batch, NULL if not converted
+};
+
+///
+/// \brief Segmentation class map at model resolution, with its placement on the frame
+///
+/// Attached as NvDsUserMeta of type nvds_get_user_meta_type( DGACCELERATOR_SEGMENTATION_META_TYPE_STRING ) when
+/// segmentation-output is model-uint8. Otherwise, the same structure without a class map is referenced by the priv_data
+/// field of the NvDsInferSegmentationMeta. Mask pixel (x, y) covers the frame pixels starting at
+/// ( offset_x + x * scale_x, offset_y + y * scale_y ), which is all a consumer needs to expand the map itself.
+///
+/// Class maps are shared by reference between the copies of the metadata and must not be modified.
+///
+struct GstDgAcceleratorSegmentationMeta
+{
+	guint64 frame_num;    //!< Frame number of the inferred buffer
+	guint width;          //!< Width of the class map
+	guint height;         //!< Height of the class map
+	gfloat offset_x;      //!< x coordinate of the region of the frame covered by the class map
+	gfloat offset_y;      //!< y coordinate of the region of the frame covered by the class map
+	gfloat scale_x;       //!< Frame pixels per class map pixel horizontally
+	gfloat scale_y;       //!< Frame pixels per class map pixel vertically
+	guint8 *class_map;    //!< Class IDs of the width * height mask pixels in row-major order, NULL in priv_data
+	gpointer priv_data;   //!< Reference to the pooled buffer holding the class map, private to the element
+};
+
+#define DGACCELERATOR_SEGMENTATION_META_TYPE_STRING "DGACCELERATOR.SEGMENTATION_META"  //!< Name of the user meta type
+
+/// \brief Area, centroid and bounding box of one class of a segmentation class map, in frame coordinates
+struct GstDgAcceleratorSegmentationClassStats
+{
+	guint class_id;     //!< Class ID
+	guint pixels;       //!< Number of class map pixels of the class
+	gfloat area;        //!< Area covered by the class, in frame pixels
+	gfloat centroid_x;  //!< x coordinate of the centroid of the class
+	gfloat centroid_y;  //!< y coordinate of the centroid of the class
+	gfloat left;        //!< x coordinate of the bounding box of the class
+	gfloat top;         //!< y coordinate of the bounding box of the class
+	gfloat width;       //!< Width of the bounding box of the class
+	gfloat height;      //!< Height of the bounding box of the class
+};
+
+///
+/// \brief Per-class statistics of a segmentation class map
+///
+/// Attached as NvDsUserMeta of type nvds_get_user_meta_type( DGACCELERATOR_SEGMENTATION_STATS_META_TYPE_STRING ) when
+/// segmentation-stats is set. Only the classes present in the map are listed, by increasing class ID.
+///
+struct GstDgAcceleratorSegmentationStatsMeta
+{
+	guint64 frame_num;                                //!< Frame number of the inferred buffer
+	guint num_classes;                                //!< Number of entries of classes
+	GstDgAcceleratorSegmentationClassStats *classes;  //!< Statistics of the classes present in the map
+};
+
+#define DGACCELERATOR_SEGMENTATION_STATS_META_TYPE_STRING "DGACCELERATOR.SEGMENTATION_STATS_META"  //!< Name of the user meta type
+
+/// \brief Polygon outlining a region of one class of a segmentation class map
+struct GstDgAcceleratorSegmentationPolygon
+{
+	guint class_id;    //!< Class ID
+	guint num_points;  //!< Number of vertices
+	gfloat *points;    //!< x and y frame coordinates of the vertices, 2 * num_points values
+};
+
+///
+/// \brief Polygons of the regions of a segmentation class map
+///
+/// Attached as NvDsUserMeta of type nvds_get_user_meta_type( DGACCELERATOR_SEGMENTATION_POLYGONS_META_TYPE_STRING )
+/// when segmentation-output is polygons. Class 0 is considered background and has no polygons.
+///
+struct GstDgAcceleratorSegmentationPolygonsMeta
+{
+	guint64 frame_num;                              //!< Frame number of the inferred buffer
+	guint num_polygons;                             //!< Number of entries of polygons
+	GstDgAcceleratorSegmentationPolygon *polygons;  //!< Polygons, by increasing class ID
+	gfloat *points;                                 //!< Storage of the vertices of all polygons
+};
+
+#define DGACCELERATOR_SEGMENTATION_POLYGONS_META_TYPE_STRING "DGACCELERATOR.SEGMENTATION_POLYGONS_META"  //!< Name of the user meta type
+
+/// \brief Keypoint of a pose, in frame coordinates
+struct GstDgAcceleratorPoseKeypoint
+{
+	gfloat x;       //!< x coordinate of the keypoint
+	gfloat y;       //!< y coordinate of the keypoint
+	gfloat score;   //!< Confidence of the keypoint
+	gint class_id;  //!< Class ID of the keypoint, identifying the body part
+};
+
+///
+/// \brief Keypoints of a pose
+///
+/// Attached as NvDsUserMeta of type nvds_get_user_meta_type( DGACCELERATOR_POSE_META_TYPE_STRING ) to the
+/// NvDsObjectMeta of each pose. The box of the object covers the keypoints, and its confidence is the confidence of
+/// the pose. Keypoints are in the order reported by the model, which is the same for every pose of a model.
+///
+struct GstDgAcceleratorPoseMeta
+{
+	guint64 frame_num;                        //!< Frame number of the inferred buffer
+	guint num_keypoints;                      //!< Number of entries of keypoints
+	GstDgAcceleratorPoseKeypoint *keypoints;  //!< Keypoints of the pose
+};
+
+#define DGACCELERATOR_POSE_META_TYPE_STRING "DGACCELERATOR.POSE_META"  //!< Name of the user meta type
+
+// Registers and gets the API type of the meta
+GType gst_dgaccelerator_frame_meta_api_get_type( void );
+
+// Registers and gets the implementation of the meta
+const GstMetaInfo *gst_dgaccelerator_frame_meta_get_info( void );
+
+// Gets the meta holding frames of the given processing resolution, adding it if add is set
+GstDgAcceleratorFrameMeta *gst_dgaccelerator_frame_meta_get( GstBuffer *buffer, gint width, gint height, gboolean add );
+
+// Gets the frame converted from a region of the frame at a batch index, NULL if there is none
+std::shared_ptr< DgAcceleratorSharedFrame > gst_dgaccelerator_frame_meta_lookup(
+	GstDgAcceleratorFrameMeta *meta,
+	guint batch_id,
+	float left,
+	float top,
+	float width,
+	float height );
+
+#endif
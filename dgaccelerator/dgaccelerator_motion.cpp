@@ -0,0 +1,66 @@
+//////////////////////////////////////////////////////////////////////
+///  \file  dgaccelerator_motion.cpp
+///  \brief Frame differencing motion gate implementation
+///
+///  Copyright 2023 DeGirum Corporation
+///
+///  Permission is hereby granted, free of charge, to any person obtaining a
+///  copy of this software and associated documentation files (the "Software"),
+///  to deal in the Software without restriction, including without limitation
+///  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///  and/or sell copies of the Software, and to permit persons to whom the
+///  Software is furnished to do so, subject to the following conditions:
+///
+///  The above copyright notice and this permission notice shall be included in
+///  all copies or substantial portions of the Software.
+///
+///  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+///  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+///  DEALINGS IN THE SOFTWARE.
+///
+
+#include <algorithm>
+
+#include "dgaccelerator_motion.h"
+
+///
+/// \brief Checks a frame against the reference thumbnail
+///
+/// The frame is area-downscaled before the color conversion so that only the thumbnail is converted to grayscale.
+/// The reference is only replaced when a frame is accepted, so slow changes accumulate until they trigger inference
+/// instead of being lost between consecutive frames, and a frame let through but then dropped does not hide its
+/// changes from the next frames.
+///
+/// \param[in] frame BGR frame at processing resolution
+/// \return true if the frame needs inference, false if it can reuse the last results
+///
+bool DgAcceleratorMotionGate::check( const cv::Mat &frame )
+{
+	const cv::Size thumbnail( std::max( 1, frame.cols / DOWNSCALE ), std::max( 1, frame.rows / DOWNSCALE ) );
+	cv::resize( frame, m_small, thumbnail, 0, 0, cv::INTER_AREA );
+	cv::cvtColor( m_small, m_gray, cv::COLOR_BGR2GRAY );
+
+	if( !m_reference.empty() && m_skipped < m_params.maxSkip )
+	{
+		cv::absdiff( m_gray, m_reference, m_diff );
+		cv::threshold( m_diff, m_diff, m_params.pixelThreshold, 255, cv::THRESH_BINARY );
+		const double changed = cv::countNonZero( m_diff ) / (double)thumbnail.area();
+		if( changed < m_params.threshold )
+		{
+			m_skipped++;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void DgAcceleratorMotionGate::accept()
+{
+	std::swap( m_gray, m_reference );
+	m_skipped = 0;
+}
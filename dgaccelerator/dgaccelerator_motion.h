@@ -0,0 +1,73 @@
+//////////////////////////////////////////////////////////////////////
+///  \file  dgaccelerator_motion.h
+///  \brief Frame differencing motion gate header file
+///
+///  Copyright 2023 DeGirum Corporation
+///
+///  Permission is hereby granted, free of charge, to any person obtaining a
+///  copy of this software and associated documentation files (the "Software"),
+///  to deal in the Software without restriction, including without limitation
+///  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///  and/or sell copies of the Software, and to permit persons to whom the
+///  Software is furnished to do so, subject to the following conditions:
+///
+///  The above copyright notice and this permission notice shall be included in
+///  all copies or substantial portions of the Software.
+///
+///  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+///  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+///  DEALINGS IN THE SOFTWARE.
+///
+
+#ifndef __DGACCELERATOR_MOTION__
+#define __DGACCELERATOR_MOTION__
+
+// OpenCV
+#include "opencv2/imgproc/imgproc.hpp"
+
+///
+/// \brief Per-source motion gate deciding whether a frame needs inference
+///
+/// Frames are reduced to a small grayscale thumbnail and compared against the thumbnail of the last frame which was
+/// accepted. A frame is let through when the fraction of changed thumbnail pixels reaches the threshold, or when
+/// too many frames in a row were held back. All image operations are vectorized OpenCV kernels.
+///
+class DgAcceleratorMotionGate
+{
+public:
+	/// \brief Motion gate tuning parameters
+	struct Params
+	{
+		double threshold;         //!< Fraction of changed pixels needed to run inference
+		unsigned pixelThreshold;  //!< Minimum absolute intensity difference for a pixel to count as changed
+		unsigned maxSkip;         //!< Maximum number of consecutive frames held back
+	};
+
+	/// \brief Constructor
+	/// \param[in] params Motion gate tuning parameters
+	explicit DgAcceleratorMotionGate( const Params &params ) : m_params( params ) {}
+
+	/// \brief Checks a frame against the reference
+	/// \param[in] frame BGR frame at processing resolution
+	/// \return true if the frame needs inference, false if it can reuse the last results
+	bool check( const cv::Mat &frame );
+
+	/// \brief Makes the last frame let through by check() the reference, once it was submitted for inference
+	void accept();
+
+private:
+	static constexpr int DOWNSCALE = 8;  //!< Thumbnail downscale factor
+
+	Params m_params;         //!< Tuning parameters
+	cv::Mat m_small;         //!< Downscaled BGR frame, reused between calls
+	cv::Mat m_gray;          //!< Grayscale thumbnail of the current frame
+	cv::Mat m_reference;     //!< Grayscale thumbnail of the last frame accepted
+	cv::Mat m_diff;          //!< Absolute difference, reused between calls
+	unsigned m_skipped = 0;  //!< Number of consecutive frames held back
+};
+
+#endif
@@ -0,0 +1,435 @@
+//////////////////////////////////////////////////////////////////////
+///  \file  dgaccelerator_registry.cpp
+///  \brief Process-wide model zoo and model connection registry implementation
+///
+///  Copyright 2023 DeGirum Corporation
+///
+///  Permission is hereby granted, free of charge, to any person obtaining a
+///  copy of this software and associated documentation files (the "Software"),
+///  to deal in the Software without restriction, including without limitation
+///  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///  and/or sell copies of the Software, and to permit persons to whom the
+///  Software is furnished to do so, subject to the following conditions:
+///
+///  The above copyright notice and this permission notice shall be included in
+///  all copies or substantial portions of the Software.
+///
+///  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+///  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+///  DEALINGS IN THE SOFTWARE.
+///
+
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "dgaccelerator_registry.h"
+
+/// \brief Time during which the model zoo listing of a server is reused
+constexpr std::chrono::seconds ZOO_CACHE_TTL( 60 );
+
+/// \brief Header of a model zoo cache file, followed by one record per model: width and height as int32, name length as
+/// uint32 and the name
+struct ZooCacheHeader
+{
+	char magic[ 4 ];    //!< ZOO_CACHE_MAGIC
+	uint32_t version;   //!< ZOO_CACHE_VERSION
+	uint32_t count;     //!< Number of model records
+	uint32_t checksum;  //!< FNV-1a hash of the records
+};
+constexpr char ZOO_CACHE_MAGIC[ 4 ] = { 'D', 'G', 'Z', 'C' };  //!< Magic of model zoo cache files
+constexpr uint32_t ZOO_CACHE_VERSION = 1;                      //!< Format version of model zoo cache files
+
+/// \brief Callback of a connection, with the number of its calls in progress
+struct DgAcceleratorModelConnection::Route
+{
+	DgAcceleratorModelCallback callback;  //!< Callback of the connection
+	int running = 0;                      //!< Number of calls of the callback in progress
+};
+
+/// \brief Model instance with the callbacks of the connections using it
+struct DgAcceleratorModelConnection::Instance
+{
+	std::mutex mutex;                                                 //!< Guards routes and nextRoute
+	std::condition_variable idle;                                     //!< Signaled when a callback call ends
+	std::unordered_map< uint64_t, Route > routes;                     //!< Callbacks of the connections, by route
+	uint64_t nextRoute = 0;                                           //!< Route of the next connection
+	std::promise< void > created;                                     //!< Set once the model instance is created, or failed to be
+	std::shared_future< void > ready = created.get_future().share();  //!< Waited for by the connections joining the instance
+	std::mutex predictMutex;                                          //!< Serializes the submissions of the connections
+	std::unique_ptr< DG::AIModelAsync > model;                        //!< Model instance, destroyed first as its callback uses routes
+};
+
+/// \brief Model zoo listing of a server
+struct ZooEntry
+{
+	std::chrono::steady_clock::time_point time;  //!< Time the listing was fetched, or read from the cache file
+	std::vector< DG::ModelInfo > models;         //!< Models of the server
+	std::thread refresh;                         //!< Background refresh of a listing read from the cache file, joinable until joined
+};
+
+/// \brief Process-wide model zoo listings, which wait for their background refreshes when destroyed
+struct ZooRegistry
+{
+	std::mutex mutex;                           //!< Guards the entries
+	std::map< std::string, ZooEntry > entries;  //!< Zoo listings, by server
+
+	/// \brief Destructor, waiting for the refreshes which still use the registry
+	~ZooRegistry()
+	{
+		for( auto &entry : entries )
+			if( entry.second.refresh.joinable() )
+				entry.second.refresh.join();
+	}
+};
+
+// Process-wide registries
+static ZooRegistry zoo;                                                                             //!< Model zoo listings
+static std::mutex instancesMutex;                                                                   //!< Guards instances
+static std::map< std::string, std::weak_ptr< DgAcceleratorModelConnection::Instance > > instances;  //!< Shared model instances, by server, model and parameters
+
+///
+/// \brief Computes the FNV-1a hash of a byte range
+/// \param[in] data Bytes to hash
+/// \param[in] size Number of bytes
+/// \return The hash
+///
+static uint32_t fnv1a( const char *data, size_t size )
+{
+	uint32_t hash = 2166136261u;
+	for( size_t i = 0; i < size; i++ )
+		hash = ( hash ^ (uint8_t)data[ i ] ) * 16777619u;
+	return hash;
+}
+
+///
+/// \brief Gets the path of the model zoo cache file of a server
+/// \param[in] cacheDir Cache directory
+/// \param[in] server Server address
+/// \return Path of the file, with the characters of the address which are not alphanumeric replaced
+///
+static std::string zooCachePath( const std::string &cacheDir, const std::string &server )
+{
+	std::string name = server;
+	for( char &c : name )
+		if( !isalnum( (unsigned char)c ) && c != '.' && c != '-' )
+			c = '_';
+	return cacheDir + "/zoo_" + name + ".bin";
+}
+
+///
+/// \brief Reads a model zoo cache file
+///
+/// The file is memory mapped and validated (magic, version, record bounds and checksum) before models are read. Only
+/// the name and resolution of the models are kept.
+///
+bool DgAcceleratorZooCacheRead( const std::string &path, std::vector< DG::ModelInfo > &models )
+{
+	const int fd = open( path.c_str(), O_RDONLY );
+	if( fd < 0 )
+		return false;
+	struct stat st;
+	if( fstat( fd, &st ) != 0 || (size_t)st.st_size < sizeof( ZooCacheHeader ) )
+	{
+		close( fd );
+		return false;
+	}
+	const size_t size = st.st_size;
+	void *mapped = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd );
+	if( mapped == MAP_FAILED )
+		return false;
+
+	const char *data = (const char *)mapped;
+	ZooCacheHeader header;
+	memcpy( &header, data, sizeof( header ) );
+	bool valid = memcmp( header.magic, ZOO_CACHE_MAGIC, sizeof( header.magic ) ) == 0 && header.version == ZOO_CACHE_VERSION &&
+		header.checksum == fnv1a( data + sizeof( header ), size - sizeof( header ) );
+	size_t offset = sizeof( header );
+	for( uint32_t i = 0; valid && i < header.count; i++ )
+	{
+		int32_t resolution[ 2 ];
+		uint32_t length;
+		if( offset + sizeof( resolution ) + sizeof( length ) > size )
+		{
+			valid = false;
+			break;
+		}
+		memcpy( resolution, data + offset, sizeof( resolution ) );
+		memcpy( &length, data + offset + sizeof( resolution ), sizeof( length ) );
+		offset += sizeof( resolution ) + sizeof( length );
+		if( offset + length > size )
+		{
+			valid = false;
+			break;
+		}
+		DG::ModelInfo model;
+		model.name.assign( data + offset, length );
+		model.W = resolution[ 0 ];
+		model.H = resolution[ 1 ];
+		models.push_back( model );
+		offset += length;
+	}
+	munmap( mapped, size );
+	if( !valid )
+		models.clear();
+	return valid;
+}
+
+///
+/// \brief Writes a model zoo cache file
+///
+/// The file is written under a temporary name and renamed, so readers never map a partially written file.
+///
+void DgAcceleratorZooCacheWrite( const std::string &path, const std::vector< DG::ModelInfo > &models )
+{
+	std::string records;
+	for( const DG::ModelInfo &model : models )
+	{
+		const int32_t resolution[ 2 ] = { (int32_t)model.W, (int32_t)model.H };
+		const uint32_t length = (uint32_t)model.name.size();
+		records.append( (const char *)resolution, sizeof( resolution ) );
+		records.append( (const char *)&length, sizeof( length ) );
+		records.append( model.name );
+	}
+	ZooCacheHeader header;
+	memcpy( header.magic, ZOO_CACHE_MAGIC, sizeof( header.magic ) );
+	header.version = ZOO_CACHE_VERSION;
+	header.count = (uint32_t)models.size();
+	header.checksum = fnv1a( records.data(), records.size() );
+
+	const std::string temporary = path + ".tmp" + std::to_string( getpid() );
+	{
+		std::ofstream file( temporary, std::ios::binary | std::ios::trunc );
+		if( !file )
+			return;  // The cache is best effort
+		file.write( (const char *)&header, sizeof( header ) );
+		file.write( records.data(), records.size() );
+		if( !file )
+		{
+			file.close();
+			unlink( temporary.c_str() );
+			return;
+		}
+	}
+	if( rename( temporary.c_str(), path.c_str() ) != 0 )
+		unlink( temporary.c_str() );
+}
+
+///
+/// \brief Gets the model zoo listing of a server and stores it in the caches
+/// \param[in] server Server address
+/// \param[in] cacheDir Directory of the cache files, empty if disabled
+/// \return The models of the server
+///
+static std::vector< DG::ModelInfo > zooFetch( const std::string &server, const std::string &cacheDir )
+{
+	std::vector< DG::ModelInfo > models;
+	DG::modelzooListGet( server, models );
+	if( !cacheDir.empty() )
+		DgAcceleratorZooCacheWrite( zooCachePath( cacheDir, server ), models );
+	std::lock_guard< std::mutex > lock( zoo.mutex );
+	ZooEntry &entry = zoo.entries[ server ];
+	entry.time = std::chrono::steady_clock::now();
+	entry.models = models;
+	return models;
+}
+
+///
+/// \brief Gets the model zoo listing of a server, cached process-wide
+///
+/// The cache file is only used on a cold start, when the process has no listing of the server yet: its background
+/// refresh is the only one started for the server, and is joined by the first call after it or by the registry. Once
+/// a listing is older than ZOO_CACHE_TTL, the server is queried synchronously.
+///
+std::vector< DG::ModelInfo > DgAcceleratorZooList( const std::string &server, const std::string &cacheDir )
+{
+	std::thread refresh;
+	{
+		std::lock_guard< std::mutex > lock( zoo.mutex );
+		auto cached = zoo.entries.find( server );
+		if( cached != zoo.entries.end() )
+		{
+			if( std::chrono::steady_clock::now() - cached->second.time < ZOO_CACHE_TTL )
+				return cached->second.models;
+			refresh = std::move( cached->second.refresh );
+		}
+		else
+		{
+			// Cold start: use the listing persisted by an earlier process, and refresh it in the background
+			std::vector< DG::ModelInfo > models;
+			if( !cacheDir.empty() && DgAcceleratorZooCacheRead( zooCachePath( cacheDir, server ), models ) )
+			{
+				ZooEntry &entry = zoo.entries[ server ];
+				entry.time = std::chrono::steady_clock::now();
+				entry.models = models;
+				entry.refresh = std::thread( [ server, cacheDir ]() {
+					try
+					{
+						zooFetch( server, cacheDir );
+					}
+					catch( const std::exception & )
+					{
+						// Keep the persisted listing until the TTL expires
+					}
+				} );
+				return models;
+			}
+		}
+	}
+	// The listing expired: wait for the refresh still running, if any, before querying the server
+	if( refresh.joinable() )
+		refresh.join();
+	return zooFetch( server, cacheDir );
+}
+
+///
+/// \brief Opens the connection, joining the shared model instance if there is one
+///
+/// A new shared model instance is registered before it is created, and created without the registry lock, so that
+/// elements starting concurrently with the same model wait for that one instance while the others proceed.
+///
+DgAcceleratorModelConnection::DgAcceleratorModelConnection(
+	const std::string &server,
+	const std::string &model,
+	const DG::ModelParamsWriter &params,
+	const std::string &paramsKey,
+	DgAcceleratorModelCallback callback,
+	bool shared )
+{
+	bool create = true;
+	if( shared )
+	{
+		m_key = server + '\n' + model + '\n' + paramsKey;
+		std::lock_guard< std::mutex > lock( instancesMutex );
+		std::weak_ptr< Instance > &registered = instances[ m_key ];
+		m_instance = registered.lock();
+		create = !m_instance;
+		if( create )
+		{
+			m_instance = std::make_shared< Instance >();
+			registered = m_instance;
+		}
+	}
+	else
+		m_instance = std::make_shared< Instance >();
+
+	if( create )
+	{
+		// Results are routed to the connection whose route prefixes the frame info
+		auto route = [ instance = m_instance.get() ]( const json &response, const std::string &fr ) {
+			const size_t separator = fr.find( ':' );
+			Route *target;
+			{
+				std::lock_guard< std::mutex > lock( instance->mutex );
+				auto found = instance->routes.find( std::stoull( fr.substr( 0, separator ) ) );
+				if( found == instance->routes.end() )
+					return;  // The connection was closed
+				target = &found->second;
+				target->running++;
+			}
+			try
+			{
+				target->callback( response, fr.substr( separator + 1 ) );
+			}
+			catch( ... )
+			{
+				routeDone( instance, target );
+				throw;
+			}
+			routeDone( instance, target );
+		};
+		try
+		{
+			// Internal frame queue size set to 48
+			m_instance->model = std::make_unique< DG::AIModelAsync >( server, model, route, params, 48u );
+			m_instance->created.set_value();
+		}
+		catch( ... )
+		{
+			m_instance->created.set_exception( std::current_exception() );
+			if( shared )
+			{
+				// Connections opened from now on create a new instance instead of joining the failed one
+				std::lock_guard< std::mutex > lock( instancesMutex );
+				instances.erase( m_key );
+			}
+			release();
+			throw;
+		}
+	}
+	else
+	{
+		try
+		{
+			m_instance->ready.get();  // Rethrows the error of the connection creating the instance
+		}
+		catch( ... )
+		{
+			release();
+			throw;
+		}
+	}
+
+	std::lock_guard< std::mutex > lock( m_instance->mutex );
+	m_route = m_instance->nextRoute++;
+	m_instance->routes[ m_route ].callback = std::move( callback );
+	m_prefix = std::to_string( m_route ) + ':';
+}
+
+DgAcceleratorModelConnection::~DgAcceleratorModelConnection()
+{
+	{
+		// Wait for the callback calls in progress, which use the callback and what it captures
+		std::unique_lock< std::mutex > lock( m_instance->mutex );
+		auto found = m_instance->routes.find( m_route );
+		m_instance->idle.wait( lock, [ & ] { return found->second.running == 0; } );
+		m_instance->routes.erase( found );
+	}
+	release();
+}
+
+void DgAcceleratorModelConnection::routeDone( Instance *instance, Route *route )
+{
+	std::lock_guard< std::mutex > lock( instance->mutex );
+	if( --route->running == 0 )
+		instance->idle.notify_all();
+}
+
+void DgAcceleratorModelConnection::release()
+{
+	m_instance.reset();
+	if( m_key.empty() )
+		return;
+	// Unregister the instance once its last user is gone, unless it was replaced meanwhile
+	std::lock_guard< std::mutex > lock( instancesMutex );
+	auto found = instances.find( m_key );
+	if( found != instances.end() && found->second.expired() )
+		instances.erase( found );
+}
+
+void DgAcceleratorModelConnection::predict( std::vector< std::vector< char > > &frame, const std::string &key )
+{
+	std::lock_guard< std::mutex > lock( m_instance->predictMutex );
+	m_instance->model->predict( frame, m_prefix + key );
+}
+
+void DgAcceleratorModelConnection::waitCompletion()
+{
+	m_instance->model->waitCompletion();
+}
@@ -0,0 +1,127 @@
+//////////////////////////////////////////////////////////////////////
+///  \file  dgaccelerator_registry.h
+///  \brief Process-wide model zoo and model connection registry header file
+///
+///  Copyright 2023 DeGirum Corporation
+///
+///  Permission is hereby granted, free of charge, to any person obtaining a
+///  copy of this software and associated documentation files (the "Software"),
+///  to deal in the Software without restriction, including without limitation
+///  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///  and/or sell copies of the Software, and to permit persons to whom the
+///  Software is furnished to do so, subject to the following conditions:
+///
+///  The above copyright notice and this permission notice shall be included in
+///  all copies or substantial portions of the Software.
+///
+///  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+///  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+///  DEALINGS IN THE SOFTWARE.
+///
+
+
+#ifndef __DGACCELERATOR_REGISTRY__
+#define __DGACCELERATOR_REGISTRY__
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Degirum
+#include "dg_model_api.h"
+#include "json.hpp"
+
+/// \brief Callback receiving the results of a frame, with the frame info given to predict()
+using DgAcceleratorModelCallback = std::function< void( const json &, const std::string & ) >;
+
+///
+/// \brief Gets the model zoo listing of a server, cached process-wide
+///
+/// Listings are kept for ZOO_CACHE_TTL, so element instances starting together in the same process make a single
+/// round trip to each server. With a cache directory, listings are also persisted to a small memory mapped file per
+/// server: a process starting cold uses the file without waiting for the server, and refreshes it once in the
+/// background. Expired listings are fetched again from the server.
+///
+/// \param[in] server Server address
+/// \param[in] cacheDir Directory of the cache files, empty to disable the persisted cache
+/// \return The models of the server
+///
+std::vector< DG::ModelInfo > DgAcceleratorZooList( const std::string &server, const std::string &cacheDir );
+
+///
+/// \brief Reads a model zoo cache file
+/// \param[in] path Path of the file
+/// \param[out] models The models read from the file, with their name and resolution
+/// \return Returns false if the file is missing or invalid (bad magic, version, record bounds or checksum)
+///
+bool DgAcceleratorZooCacheRead( const std::string &path, std::vector< DG::ModelInfo > &models );
+
+///
+/// \brief Writes a model zoo cache file, best effort
+/// \param[in] path Path of the file
+/// \param[in] models The models to write
+///
+void DgAcceleratorZooCacheWrite( const std::string &path, const std::vector< DG::ModelInfo > &models );
+
+///
+/// \brief Connection of an element to a model instance on a server
+///
+/// Connections opened as shared by element instances of the same process with the same server, model and model
+/// parameters use one model instance, released with its last user. Each connection has its own callback: frame
+/// infos are prefixed with the route of the connection, so results are delivered to the element which submitted the
+/// frame.
+///
+class DgAcceleratorModelConnection
+{
+public:
+	/// \brief Opens a connection to a model instance
+	/// \param[in] server Server address
+	/// \param[in] model The full name of the model
+	/// \param[in] params Model parameters
+	/// \param[in] paramsKey String identifying the model parameters, to match shared instances
+	/// \param[in] callback Callback receiving the results of the frames submitted through this connection
+	/// \param[in] shared Whether to share the model instance with other connections of the process
+	DgAcceleratorModelConnection(
+		const std::string &server,
+		const std::string &model,
+		const DG::ModelParamsWriter &params,
+		const std::string &paramsKey,
+		DgAcceleratorModelCallback callback,
+		bool shared );
+
+	/// \brief Closes the connection, releasing the model instance if this was its last user
+	~DgAcceleratorModelConnection();
+
+	/// \brief Submits a frame to the model instance
+	/// \param[in] frame The model input vector
+	/// \param[in] key Frame info passed back to the callback with the results
+	void predict( std::vector< std::vector< char > > &frame, const std::string &key );
+
+	/// \brief Waits until the results of all frames submitted to the model instance are received
+	void waitCompletion();
+
+	struct Instance;
+	struct Route;
+
+private:
+	/// \brief Ends a callback call, waking up the connection waiting to close if it was the last one
+	/// \param[in] instance The model instance
+	/// \param[in] route The route of the callback
+	static void routeDone( Instance *instance, Route *route );
+
+	/// \brief Drops the model instance, unregistering it if this was its last user
+	void release();
+
+	std::shared_ptr< Instance > m_instance;  //!< Model instance, possibly shared
+	std::string m_key;                       //!< Key of the shared model instance in the registry, empty if not shared
+	uint64_t m_route;                        //!< Route of this connection in the model instance
+	std::string m_prefix;                    //!< Frame info prefix carrying the route
+};
+
+#endif
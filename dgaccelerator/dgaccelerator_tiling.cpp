@@ -0,0 +1,153 @@
+//////////////////////////////////////////////////////////////////////
+///  \file  dgaccelerator_tiling.cpp
+///  \brief Tiled inference layout and merging implementation
+///
+///  Copyright 2023 DeGirum Corporation
+///
+///  Permission is hereby granted, free of charge, to any person obtaining a
+///  copy of this software and associated documentation files (the "Software"),
+///  to deal in the Software without restriction, including without limitation
+///  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///  and/or sell copies of the Software, and to permit persons to whom the
+///  Software is furnished to do so, subject to the following conditions:
+///
+///  The above copyright notice and this permission notice shall be included in
+///  all copies or substantial portions of the Software.
+///
+///  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+///  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+///  DEALINGS IN THE SOFTWARE.
+///
+
+
+#include <algorithm>
+#include <cmath>
+
+#include "dgaccelerator_tiling.h"
+
+constexpr float TILE_BORDER_MARGIN = 2.f;  //!< Distance to a tile border, in pixels, below which a detection is cut by it
+
+/// \brief Detection of a tile, mapped into the region
+struct TileDetection
+{
+	DgAcceleratorObject object;  //!< Detection, in processing resolution coordinates of the whole region
+	size_t tile;                 //!< Index of the tile
+	bool cut;                    //!< Whether the detection touches a border of the tile inside the region
+};
+
+///
+/// \brief Computes the tile origins along one dimension
+/// \param[in] size Size of the region along the dimension
+/// \param[in] tile Size of a tile along the dimension
+/// \param[in] overlap Minimum overlap between neighbouring tiles, as a fraction of the tile size
+/// \return Tile origins, evenly spread so that the first and last tiles touch the region borders
+///
+static std::vector< int > tileOrigins( int size, int tile, double overlap )
+{
+	if( size <= tile )
+		return { 0 };
+	const int count = std::max( 2, (int)std::ceil( ( size - tile * overlap ) / ( tile * ( 1 - overlap ) ) ) );
+	const double step = ( size - tile ) / (double)( count - 1 );
+	std::vector< int > origins( count );
+	for( int i = 0; i < count; i++ )
+		origins[ i ] = (int)std::lround( i * step );
+	return origins;
+}
+
+std::vector< DgAcceleratorTile > DgAcceleratorTileLayout( int width, int height, int tileWidth, int tileHeight, double overlap )
+{
+	std::vector< DgAcceleratorTile > tiles;
+	for( int top : tileOrigins( height, tileHeight, overlap ) )
+		for( int left : tileOrigins( width, tileWidth, overlap ) )
+			tiles.push_back( { left, top, std::min( tileWidth, width ), std::min( tileHeight, height ) } );
+	return tiles;
+}
+
+///
+/// \brief Computes the intersection of two boxes over the area of the smaller one
+///
+/// Unlike IoU, this also matches the part of an object cut by a tile border with the whole object seen by a
+/// neighbouring tile.
+///
+/// \param[in] a First box
+/// \param[in] b Second box
+/// \return Overlap in the [0, 1] range
+///
+static float overlapOverSmaller( const DgAcceleratorObject &a, const DgAcceleratorObject &b )
+{
+	const float x1 = std::max( a.left, b.left );
+	const float y1 = std::max( a.top, b.top );
+	const float x2 = std::min( a.left + a.width, b.left + b.width );
+	const float y2 = std::min( a.top + a.height, b.top + b.height );
+	if( x2 <= x1 || y2 <= y1 )
+		return 0.f;
+	return ( x2 - x1 ) * ( y2 - y1 ) / std::max( std::min( a.width * a.height, b.width * b.height ), 1.f );
+}
+
+void DgAcceleratorMergeTiles(
+	const std::vector< DgAcceleratorTile > &tiles,
+	DgAcceleratorOutput *const *outputs,
+	int width,
+	int height,
+	int processingWidth,
+	int processingHeight,
+	float nmsThreshold,
+	DgAcceleratorOutput &merged )
+{
+	// Map the detections of every tile into processing resolution coordinates of the whole region
+	std::vector< TileDetection > candidates;
+	bool inferred = false;
+	for( size_t t = 0; t < tiles.size(); t++ )
+	{
+		const DgAcceleratorTile &tile = tiles[ t ];
+		const float scaleX = tile.width / (float)width;
+		const float scaleY = tile.height / (float)height;
+		const float offsetX = tile.left * processingWidth / (float)width;
+		const float offsetY = tile.top * processingHeight / (float)height;
+		for( int i = 0; i < outputs[ t ]->numObjects; i++ )
+		{
+			DgAcceleratorObject obj = outputs[ t ]->object[ i ];
+			const bool cut = ( tile.left > 0 && obj.left < TILE_BORDER_MARGIN ) || ( tile.top > 0 && obj.top < TILE_BORDER_MARGIN ) ||
+							 ( tile.left + tile.width < width && obj.left + obj.width > processingWidth - TILE_BORDER_MARGIN ) ||
+							 ( tile.top + tile.height < height && obj.top + obj.height > processingHeight - TILE_BORDER_MARGIN );
+			obj.left = offsetX + obj.left * scaleX;
+			obj.top = offsetY + obj.top * scaleY;
+			obj.width *= scaleX;
+			obj.height *= scaleY;
+			candidates.push_back( { obj, t, cut } );
+		}
+		inferred |= outputs[ t ]->inferred;
+		outputs[ t ]->inferred = false;
+	}
+
+	// Class-aware NMS: whole objects first so that they win over the parts cut by tile borders, then by decreasing
+	// score, then by decreasing area. Detections of the same tile already went through the NMS of the model, so only
+	// detections of different tiles suppress each other.
+	std::stable_sort( candidates.begin(), candidates.end(), []( const TileDetection &a, const TileDetection &b ) {
+		if( a.cut != b.cut )
+			return b.cut;
+		if( a.object.score != b.object.score )
+			return a.object.score > b.object.score;
+		return a.object.width * a.object.height > b.object.width * b.object.height;
+	} );
+	size_t mergedTiles[ MAX_OBJ_PER_FRAME ];
+	merged.numObjects = 0;
+	for( size_t i = 0; i < candidates.size() && merged.numObjects < MAX_OBJ_PER_FRAME; i++ )
+	{
+		const DgAcceleratorObject &candidate = candidates[ i ].object;
+		bool suppressed = false;
+		for( int j = 0; j < merged.numObjects && !suppressed; j++ )
+			suppressed = candidates[ i ].tile != mergedTiles[ j ] && candidate.classId == merged.object[ j ].classId &&
+						 overlapOverSmaller( candidate, merged.object[ j ] ) > nmsThreshold;
+		if( !suppressed )
+		{
+			mergedTiles[ merged.numObjects ] = candidates[ i ].tile;
+			merged.object[ merged.numObjects++ ] = candidate;
+		}
+	}
+	merged.inferred = inferred;
+}
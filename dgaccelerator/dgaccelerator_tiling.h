@@ -0,0 +1,63 @@
+//////////////////////////////////////////////////////////////////////
+///  \file  dgaccelerator_tiling.h
+///  \brief Tiled inference layout and merging header file
+///
+///  Copyright 2023 DeGirum Corporation
+///
+///  Permission is hereby granted, free of charge, to any person obtaining a
+///  copy of this software and associated documentation files (the "Software"),
+///  to deal in the Software without restriction, including without limitation
+///  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///  and/or sell copies of the Software, and to permit persons to whom the
+///  Software is furnished to do so, subject to the following conditions:
+///
+///  The above copyright notice and this permission notice shall be included in
+///  all copies or substantial portions of the Software.
+///
+///  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+///  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+///  DEALINGS IN THE SOFTWARE.
+///
+
+
+#ifndef __DGACCELERATOR_TILING__
+#define __DGACCELERATOR_TILING__
+
+#include <vector>
+
+#include "dgaccelerator_lib.h"
+
+/// \brief Computes the tiles covering a region, computed once per region size
+/// \param[in] width Width of the region
+/// \param[in] height Height of the region
+/// \param[in] tileWidth Width of a tile, usually the processing width
+/// \param[in] tileHeight Height of a tile, usually the processing height
+/// \param[in] overlap Minimum overlap between neighbouring tiles, as a fraction of the tile size
+/// \return Tiles in row-major order, in region coordinates
+std::vector< DgAcceleratorTile > DgAcceleratorTileLayout( int width, int height, int tileWidth, int tileHeight, double overlap );
+
+/// \brief Merges the detections of all tiles of a region with class-aware NMS between detections of different tiles
+/// \param[in] tiles Tiles of the region
+/// \param[in] outputs Results of each tile, in processing resolution coordinates of the tile
+/// \param[in] width Width of the region
+/// \param[in] height Height of the region
+/// \param[in] processingWidth Processing width
+/// \param[in] processingHeight Processing height
+/// \param[in] nmsThreshold Overlap above which the weaker of two boxes of the same class and different tiles is suppressed:
+/// the one cut by a tile border, or else the one of lower score
+/// \param[out] merged Detections of the region, in processing resolution coordinates of the whole region
+void DgAcceleratorMergeTiles(
+	const std::vector< DgAcceleratorTile > &tiles,
+	DgAcceleratorOutput *const *outputs,
+	int width,
+	int height,
+	int processingWidth,
+	int processingHeight,
+	float nmsThreshold,
+	DgAcceleratorOutput &merged );
+
+#endif
@@ -0,0 +1,238 @@
+//////////////////////////////////////////////////////////////////////
+///  \file  dgaccelerator_tracker.cpp
+///  \brief Lightweight IoU / Kalman object tracker implementation
+///
+///  Copyright 2023 DeGirum Corporation
+///
+///  Permission is hereby granted, free of charge, to any person obtaining a
+///  copy of this software and associated documentation files (the "Software"),
+///  to deal in the Software without restriction, including without limitation
+///  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///  and/or sell copies of the Software, and to permit persons to whom the
+///  Software is furnished to do so, subject to the following conditions:
+///
+///  The above copyright notice and this permission notice shall be included in
+///  all copies or substantial portions of the Software.
+///
+///  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+///  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+///  DEALINGS IN THE SOFTWARE.
+///
+
+#include <algorithm>
+#include <atomic>
+#include <tuple>
+
+#include "dgaccelerator_tracker.h"
+
+// Kalman filter noise weights, relative to the box height (same weighting as DeepSORT)
+constexpr float STD_WEIGHT_POSITION = 1.f / 20.f;   //!< Position noise weight
+constexpr float STD_WEIGHT_VELOCITY = 1.f / 160.f;  //!< Velocity noise weight
+
+/// \brief ID of the next track, shared by the trackers of all sources, models and elements of the process so that
+/// objects of the same frame never get the same ID
+static std::atomic< uint64_t > nextTrackId{ 1 };
+
+///
+/// \brief Computes the intersection over union of two boxes
+/// \param[in] a First box
+/// \param[in] b Second box
+/// \return IoU in the [0, 1] range
+///
+static float iou( const DgAcceleratorObject &a, const DgAcceleratorObject &b )
+{
+	const float x1 = std::max( a.left, b.left );
+	const float y1 = std::max( a.top, b.top );
+	const float x2 = std::min( a.left + a.width, b.left + b.width );
+	const float y2 = std::min( a.top + a.height, b.top + b.height );
+	if( x2 <= x1 || y2 <= y1 )
+		return 0.f;
+	const float intersection = ( x2 - x1 ) * ( y2 - y1 );
+	return intersection / ( a.width * a.height + b.width * b.height - intersection );
+}
+
+DgAcceleratorTracker::DgAcceleratorTracker( const Params &params ) : m_params( params )
+{}
+
+void DgAcceleratorTracker::predict()
+{
+	const size_t n = m_ids.size();
+	for( int d = 0; d < DIMS; d++ )
+	{
+		float *pos = m_pos[ d ].data(), *vel = m_vel[ d ].data();
+		float *p00 = m_p00[ d ].data(), *p01 = m_p01[ d ].data(), *p11 = m_p11[ d ].data();
+		const float *height = m_pos[ 3 ].data();
+		for( size_t i = 0; i < n; i++ )
+		{
+			const float h = std::max( height[ i ], 1.f );
+			const float qPos = STD_WEIGHT_POSITION * h * STD_WEIGHT_POSITION * h;
+			const float qVel = STD_WEIGHT_VELOCITY * h * STD_WEIGHT_VELOCITY * h;
+			// x' = F x, P' = F P F^T + Q with F = [1 1; 0 1]
+			pos[ i ] += vel[ i ];
+			p00[ i ] += 2 * p01[ i ] + p11[ i ] + qPos;
+			p01[ i ] += p11[ i ];
+			p11[ i ] += qVel;
+		}
+	}
+	for( size_t i = 0; i < n; i++ )
+		m_age[ i ]++;
+
+	// Retire tracks which were not matched for too long
+	for( size_t i = m_ids.size(); i-- > 0; )
+		if( m_age[ i ] > m_params.maxAge )
+			remove( i );
+}
+
+void DgAcceleratorTracker::update( const DgAcceleratorObject *detections, int count )
+{
+	// Greedy association: highest IoU pairs first, classes must match
+	std::vector< std::tuple< float, size_t, int > > pairs;
+	for( size_t t = 0; t < m_ids.size(); t++ )
+	{
+		const DgAcceleratorObject predicted = box( t );
+		for( int d = 0; d < count; d++ )
+		{
+			if( m_classIds[ t ] != detections[ d ].classId )
+				continue;
+			const float overlap = iou( predicted, detections[ d ] );
+			if( overlap >= m_params.iouThreshold )
+				pairs.emplace_back( overlap, t, d );
+		}
+	}
+	std::sort( pairs.begin(), pairs.end(), []( const auto &a, const auto &b ) { return std::get< 0 >( a ) > std::get< 0 >( b ); } );
+
+	std::vector< bool > trackMatched( m_ids.size(), false );
+	std::vector< bool > detectionMatched( count, false );
+	for( const auto &[ overlap, t, d ] : pairs )
+	{
+		if( trackMatched[ t ] || detectionMatched[ d ] )
+			continue;
+		trackMatched[ t ] = detectionMatched[ d ] = true;
+		correct( t, detections[ d ] );
+	}
+
+	for( size_t t = 0; t < trackMatched.size(); t++ )
+		if( !trackMatched[ t ] )
+			m_misses[ t ]++;
+
+	// Unmatched detections start new tracks
+	for( int d = 0; d < count; d++ )
+		if( !detectionMatched[ d ] )
+			add( detections[ d ] );
+}
+
+int DgAcceleratorTracker::get( DgAcceleratorTrackedObject *tracks, int maxTracks ) const
+{
+	int n = 0;
+	for( size_t i = 0; i < m_ids.size() && n < maxTracks; i++ )
+	{
+		// Tracks lost on the last inferred frame are kept alive for re-association, but not reported
+		if( m_misses[ i ] != 0 )
+			continue;
+		tracks[ n ].object = box( i );
+		tracks[ n ].id = m_ids[ i ];
+		n++;
+	}
+	return n;
+}
+
+///
+/// \brief Starts a new track from a detection
+/// \param[in] detection The detection
+///
+void DgAcceleratorTracker::add( const DgAcceleratorObject &detection )
+{
+	const float z[ DIMS ] = { detection.left + detection.width / 2, detection.top + detection.height / 2, detection.width, detection.height };
+	const float h = std::max( detection.height, 1.f );
+	m_ids.push_back( nextTrackId++ );
+	m_age.push_back( 0 );
+	m_misses.push_back( 0 );
+	m_labelIds.push_back( detection.labelId );
+	m_classIds.push_back( detection.classId );
+	m_scores.push_back( detection.score );
+	for( int d = 0; d < DIMS; d++ )
+	{
+		m_pos[ d ].push_back( z[ d ] );
+		m_vel[ d ].push_back( 0.f );
+		m_p00[ d ].push_back( 4 * STD_WEIGHT_POSITION * h * STD_WEIGHT_POSITION * h );
+		m_p01[ d ].push_back( 0.f );
+		m_p11[ d ].push_back( 100 * STD_WEIGHT_VELOCITY * h * STD_WEIGHT_VELOCITY * h );
+	}
+}
+
+///
+/// \brief Removes a track by swapping it with the last one
+/// \param[in] index Index of the track
+///
+void DgAcceleratorTracker::remove( size_t index )
+{
+	const size_t last = m_ids.size() - 1;
+	m_ids[ index ] = m_ids[ last ];
+	m_age[ index ] = m_age[ last ];
+	m_misses[ index ] = m_misses[ last ];
+	m_labelIds[ index ] = m_labelIds[ last ];
+	m_classIds[ index ] = m_classIds[ last ];
+	m_scores[ index ] = m_scores[ last ];
+	m_ids.pop_back();
+	m_age.pop_back();
+	m_misses.pop_back();
+	m_labelIds.pop_back();
+	m_classIds.pop_back();
+	m_scores.pop_back();
+	for( auto *arrays : { m_pos, m_vel, m_p00, m_p01, m_p11 } )
+		for( int d = 0; d < DIMS; d++ )
+		{
+			arrays[ d ][ index ] = arrays[ d ][ last ];
+			arrays[ d ].pop_back();
+		}
+}
+
+///
+/// \brief Kalman measurement update of a track with its matched detection
+/// \param[in] index Index of the track
+/// \param[in] detection The matched detection
+///
+void DgAcceleratorTracker::correct( size_t index, const DgAcceleratorObject &detection )
+{
+	const float z[ DIMS ] = { detection.left + detection.width / 2, detection.top + detection.height / 2, detection.width, detection.height };
+	const float h = std::max( m_pos[ 3 ][ index ], 1.f );
+	const float r = STD_WEIGHT_POSITION * h * STD_WEIGHT_POSITION * h;
+	for( int d = 0; d < DIMS; d++ )
+	{
+		float &p00 = m_p00[ d ][ index ], &p01 = m_p01[ d ][ index ], &p11 = m_p11[ d ][ index ];
+		const float innovation = z[ d ] - m_pos[ d ][ index ];
+		const float s = p00 + r;
+		const float k0 = p00 / s;
+		const float k1 = p01 / s;
+		m_pos[ d ][ index ] += k0 * innovation;
+		m_vel[ d ][ index ] += k1 * innovation;
+		p11 -= k1 * p01;
+		p01 -= k0 * p01;
+		p00 -= k0 * p00;
+	}
+	m_scores[ index ] = detection.score;
+	m_age[ index ] = 0;
+	m_misses[ index ] = 0;
+}
+
+///
+/// \brief Converts the filtered state of a track into a box
+/// \param[in] index Index of the track
+/// \return The box with the label, class and confidence of the track
+///
+DgAcceleratorObject DgAcceleratorTracker::box( size_t index ) const
+{
+	DgAcceleratorObject obj;
+	obj.width = std::max( m_pos[ 2 ][ index ], 0.f );
+	obj.height = std::max( m_pos[ 3 ][ index ], 0.f );
+	obj.left = m_pos[ 0 ][ index ] - obj.width / 2;
+	obj.top = m_pos[ 1 ][ index ] - obj.height / 2;
+	obj.labelId = m_labelIds[ index ];
+	obj.score = m_scores[ index ];
+	obj.classId = m_classIds[ index ];
+	return obj;
+}
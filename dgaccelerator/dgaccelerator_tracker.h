@@ -0,0 +1,96 @@
+//////////////////////////////////////////////////////////////////////
+///  \file  dgaccelerator_tracker.h
+///  \brief Lightweight IoU / Kalman object tracker header file
+///
+///  Copyright 2023 DeGirum Corporation
+///
+///  Permission is hereby granted, free of charge, to any person obtaining a
+///  copy of this software and associated documentation files (the "Software"),
+///  to deal in the Software without restriction, including without limitation
+///  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+///  and/or sell copies of the Software, and to permit persons to whom the
+///  Software is furnished to do so, subject to the following conditions:
+///
+///  The above copyright notice and this permission notice shall be included in
+///  all copies or substantial portions of the Software.
+///
+///  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+///  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+///  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+///  DEALINGS IN THE SOFTWARE.
+///
+
+#ifndef __DGACCELERATOR_TRACKER__
+#define __DGACCELERATOR_TRACKER__
+
+#include <cstdint>
+#include <vector>
+
+#include "dgaccelerator_lib.h"
+
+///
+/// \brief Per-source multi-object tracker
+///
+/// Detections are associated to tracks by greedy, class-aware IoU matching on class IDs. Every track runs a constant-velocity
+/// Kalman filter on each of its box coordinates (center x, center y, width, height), so boxes can be extrapolated
+/// on frames that were not inferred. Track state is kept as a structure of arrays.
+///
+class DgAcceleratorTracker
+{
+public:
+	/// \brief Tracker tuning parameters
+	struct Params
+	{
+		float iouThreshold;  //!< Minimum IoU between a predicted track and a detection to associate them
+		unsigned maxAge;     //!< Number of frames a track survives without being matched to a detection
+	};
+
+	/// \brief Constructor
+	/// \param[in] params Tracker tuning parameters
+	explicit DgAcceleratorTracker( const Params &params );
+
+	/// \brief Advances all tracks by one frame using their motion model
+	void predict();
+
+	/// \brief Corrects the tracks with the detections of an inferred frame, must follow predict()
+	/// \param[in] detections Array of detections in processing resolution coordinates
+	/// \param[in] count Number of detections
+	void update( const DgAcceleratorObject *detections, int count );
+
+	/// \brief Reports the tracks which were matched on the last inferred frame
+	/// \param[out] tracks Array to fill
+	/// \param[in] maxTracks Capacity of the array
+	/// \return Number of reported tracks
+	int get( DgAcceleratorTrackedObject *tracks, int maxTracks ) const;
+
+	/// \brief Number of live tracks
+	size_t size() const { return m_ids.size(); }
+
+private:
+	static constexpr int DIMS = 4;  //!< Filtered box coordinates: center x, center y, width, height
+
+	void add( const DgAcceleratorObject &detection );
+	void remove( size_t index );
+	void correct( size_t index, const DgAcceleratorObject &detection );
+	DgAcceleratorObject box( size_t index ) const;
+
+	Params m_params;  //!< Tuning parameters
+
+	// Track state, one element per track
+	std::vector< uint64_t > m_ids;       //!< Track IDs
+	std::vector< unsigned > m_age;       //!< Frames since the last matched detection
+	std::vector< unsigned > m_misses;    //!< Inferred frames since the last matched detection
+	std::vector< uint16_t > m_labelIds;  //!< Track label IDs
+	std::vector< int > m_classIds;       //!< Track class IDs
+	std::vector< float > m_scores;       //!< Confidence of the last matched detection
+	std::vector< float > m_pos[ DIMS ];  //!< Filtered coordinates
+	std::vector< float > m_vel[ DIMS ];  //!< Filtered velocities, per frame
+	std::vector< float > m_p00[ DIMS ];  //!< Coordinate variance
+	std::vector< float > m_p01[ DIMS ];  //!< Coordinate/velocity covariance
+	std::vector< float > m_p11[ DIMS ];  //!< Velocity variance
+};
+
+#endif
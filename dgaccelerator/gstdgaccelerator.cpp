@@ -32,6 +32,7 @@
 #include <string>
 #include <string_view>
 
+#include "dgaccelerator_meta.h"
 #include "gstdgaccelerator.h"
 #include "nvdefines.h"
 
@@ -63,7 +64,41 @@ enum
 	PROP_MAX_DETECTIONS,
 	PROP_MAX_DETECTIONS_PER_CLASS,
 	PROP_MAX_CLASSES_PER_DETECTION,
-	PROP_USE_REGULAR_NMS
+	PROP_USE_REGULAR_NMS,
+	PROP_TRACKER,
+	PROP_TRACKER_IOU_THRESHOLD,
+	PROP_TRACKER_MAX_AGE,
+	PROP_MOTION_THRESHOLD,
+	PROP_MOTION_PIXEL_THRESHOLD,
+	PROP_MOTION_MAX_SKIP,
+	PROP_DEDUP_CACHE_SIZE,
+	PROP_DEDUP_HAMMING_THRESHOLD,
+	PROP_DEDUP_MAX_REUSE,
+	PROP_ROI,
+	PROP_TILING,
+	PROP_TILE_OVERLAP,
+	PROP_TILE_NMS_THRESHOLD,
+	PROP_PROCESS_MODE,
+	PROP_OPERATE_ON_CLASS_IDS,
+	PROP_INPUT_OBJECT_MIN_WIDTH,
+	PROP_INPUT_OBJECT_MIN_HEIGHT,
+	PROP_SECONDARY_REINFER_INTERVAL,
+	PROP_EXTRA_MODELS,
+	PROP_CONNECTIONS,
+	PROP_RECONNECT,
+	PROP_RECONNECT_MAX_DELAY,
+	PROP_ASYNC_START,
+	PROP_WARM_UP_FRAMES,
+	PROP_SHARE_CONNECTION,
+	PROP_ZOO_CACHE_DIR,
+	PROP_SEGMENTATION_OUTPUT,
+	PROP_SEGMENTATION_STATS,
+	PROP_POLYGON_TOLERANCE,
+	PROP_DRAW,
+	PROP_CLASS_FILTER,
+	PROP_MIN_CONFIDENCE,
+	PROP_MIN_BOX_SIZE,
+	PROP_SHARE_FRAMES
 };
 
 // DEFAULT PROPERTY VALUES
@@ -87,9 +122,44 @@ enum
 #define DEFAULT_MAX_DETECTIONS_PER_CLASS  100                                        //!< Default maximum detections per class
 #define DEFAULT_MAX_CLASSES_PER_DETECTION 30                                         //!< Default maximum classes per detection
 #define DEFAULT_USE_REGULAR_NMS           true                                       //!< Default use regular NMS
+#define DEFAULT_TRACKER                   false                                      //!< Default built-in tracker toggle
+#define DEFAULT_TRACKER_IOU_THRESHOLD     0.3                                        //!< Default tracker IoU threshold
+#define DEFAULT_TRACKER_MAX_AGE           30                                         //!< Default tracker maximum age in frames
+#define DEFAULT_MOTION_THRESHOLD          0.0                                        //!< Default motion threshold (gate disabled)
+#define DEFAULT_MOTION_PIXEL_THRESHOLD    25                                         //!< Default per-pixel motion threshold
+#define DEFAULT_MOTION_MAX_SKIP           30                                         //!< Default maximum consecutive gated frames
+#define DEFAULT_DEDUP_CACHE_SIZE          0                                          //!< Default result cache size (cache disabled)
+#define DEFAULT_DEDUP_HAMMING_THRESHOLD   2                                          //!< Default maximum hash distance of duplicate frames
+#define DEFAULT_DEDUP_MAX_REUSE           30                                         //!< Default maximum reuses of cached results
+#define DEFAULT_ROI                       ""                                         //!< Default regions of interest (full frames)
+#define DEFAULT_TILING                    false                                      //!< Default tiling toggle
+#define DEFAULT_TILE_OVERLAP              0.2                                        //!< Default minimum overlap between tiles
+#define DEFAULT_TILE_NMS_THRESHOLD        0.5                                        //!< Default tile merging NMS threshold
+#define DEFAULT_PROCESS_MODE              DGACCELERATOR_PROCESS_MODE_PRIMARY         //!< Default process mode (full frames)
+#define DEFAULT_OPERATE_ON_CLASS_IDS      ""                                         //!< Default class IDs of inferred objects (all)
+#define DEFAULT_INPUT_OBJECT_MIN_WIDTH    0                                          //!< Default minimum width of inferred objects
+#define DEFAULT_INPUT_OBJECT_MIN_HEIGHT   0                                          //!< Default minimum height of inferred objects
+#define DEFAULT_REINFER_INTERVAL          30                                         //!< Default object re-inference interval in frames
+#define DEFAULT_EXTRA_MODELS              ""                                         //!< Default additional models (none)
+#define DEFAULT_CONNECTIONS               1                                          //!< Default number of connections per server
+#define DEFAULT_RECONNECT                 FALSE                                      //!< Default reconnection toggle (errors stop the pipeline)
+#define DEFAULT_RECONNECT_MAX_DELAY       30000                                      //!< Default maximum reconnection delay in milliseconds
+#define DEFAULT_ASYNC_START               FALSE                                      //!< Default asynchronous startup toggle (connect in start)
+#define DEFAULT_WARM_UP_FRAMES            0                                          //!< Default number of warm-up frames (none)
+#define DEFAULT_SHARE_CONNECTION          FALSE                                      //!< Default connection sharing toggle (own model instances)
+#define DEFAULT_ZOO_CACHE_DIR             ""                                         //!< Default model zoo cache directory (disabled)
+#define DEFAULT_SEGMENTATION_OUTPUT       DGACCELERATOR_SEGMENTATION_OUTPUT_FRAME    //!< Default segmentation output (frame resolution)
+#define DEFAULT_SEGMENTATION_STATS        FALSE                                      //!< Default segmentation statistics toggle (disabled)
+#define DEFAULT_POLYGON_TOLERANCE         1.0                                        //!< Default polygon simplification tolerance
+#define DEFAULT_DRAW                      TRUE                                       //!< Default drawing toggle (decorate results for nvdsosd)
+#define DEFAULT_CLASS_FILTER              ""                                         //!< Default class IDs of attached results (all)
+#define DEFAULT_MIN_CONFIDENCE            0.0                                        //!< Default minimum confidence of attached results
+#define DEFAULT_MIN_BOX_SIZE              0                                          //!< Default minimum size of attached detections
+#define DEFAULT_SHARE_FRAMES              FALSE                                      //!< Default share frames toggle
 
 
 #define GST_CAPS_FEATURE_MEMORY_NVMM "memory:NVMM"  //!< NVIDIA hardware-allocated memory
+#define SWAP_WARMUP_FRAMES           2              //!< Frames inferred by each instance of a model swapped in PLAYING state before switching to it
 
 /// \brief Template for sink pad
 static GstStaticPadTemplate gst_dgaccelerator_sink_template = GST_STATIC_PAD_TEMPLATE(
@@ -108,6 +178,7 @@ static GstStaticPadTemplate gst_dgaccelerator_src_template = GST_STATIC_PAD_TEMP
 #define gst_dgaccelerator_parent_class parent_class                             //!< gstreamer parent class boilerplate
 G_DEFINE_TYPE( GstDgAccelerator, gst_dgaccelerator, GST_TYPE_BASE_TRANSFORM );  //!< gstreamer base class boilerplate
 
+static void gst_dgaccelerator_finalize( GObject *object );
 static void gst_dgaccelerator_set_property( GObject *object, guint prop_id, const GValue *value, GParamSpec *pspec );
 static void gst_dgaccelerator_get_property( GObject *object, guint prop_id, GValue *value, GParamSpec *pspec );
 static gboolean gst_dgaccelerator_set_caps( GstBaseTransform *btrans, GstCaps *incaps, GstCaps *outcaps );
@@ -116,13 +187,60 @@ static gboolean gst_dgaccelerator_stop( GstBaseTransform *btrans );
 static GstFlowReturn gst_dgaccelerator_transform_ip( GstBaseTransform *btrans, GstBuffer *inbuf );
 static void attach_metadata_full_frame(
 	GstDgAccelerator *dgaccelerator,
+	DgAcceleratorCtx *ctx,
+	gint model_width,
+	gint model_height,
 	NvDsFrameMeta *frame_meta,
 	gdouble scale_ratio,
 	DgAcceleratorOutput *output,
-	guint batch_id );
+	guint batch_id,
+	const NvOSD_RectParams *roi );
+static gboolean parse_roi( const char *roi, std::map< guint, NvOSD_RectParams > &roi_map );
+static gboolean parse_class_ids( const char *class_ids, std::set< gint > &class_id_set );
+static gboolean parse_extra_models( const char *extra_models, gint width, gint height, std::vector< GstDgAcceleratorModel > &model_list );
+static void free_extra_models( GstDgAccelerator *dgaccelerator );
+static void init_models( GstDgAccelerator *dgaccelerator );
+static gboolean init_wait( GstDgAccelerator *dgaccelerator );
+static void model_string_set( GstDgAccelerator *dgaccelerator, char *&current, char *&pending, const char *value );
+static void model_swap_join( GstDgAccelerator *dgaccelerator );
+static void model_swap_free( GstDgAcceleratorSwap *swap );
+static void model_swap_start( GstDgAccelerator *dgaccelerator );
+static void model_swap_request( GstDgAccelerator *dgaccelerator );
+static void model_swap_apply( GstDgAccelerator *dgaccelerator );
+static void model_swap_stop( GstDgAccelerator *dgaccelerator );
+static GstFlowReturn process_objects( GstDgAccelerator *dgaccelerator, NvBufSurface *surface, NvDsBatchMeta *batch_meta );
+static void attach_classifier_metadata(
+	GstDgAccelerator *dgaccelerator,
+	DgAcceleratorCtx *ctx,
+	NvDsBatchMeta *batch_meta,
+	NvDsObjectMeta *object_meta,
+	const DgAcceleratorClassObject *classes,
+	gint count );
 static void releaseSegmentationMeta( gpointer data, gpointer user_data );
 static gpointer copySegmentationMeta( gpointer data, gpointer user_data );
-void attachSegmentationMetadata( NvDsFrameMeta *frameMeta, guint64 frame_num, int width, int height, const int *class_map );
+void attachSegmentationMetadata( NvDsFrameMeta *frameMeta,
+	guint64 frame_num,
+	const DgAcceleratorMaskBuffer &class_map,
+	const GstDgAcceleratorSegmentationMeta &placement );
+static void releaseSegmentationUint8Meta( gpointer data, gpointer user_data );
+static gpointer copySegmentationUint8Meta( gpointer data, gpointer user_data );
+void attachSegmentationUint8Metadata( NvDsFrameMeta *frameMeta,
+	const DgAcceleratorMaskBuffer &class_map,
+	const GstDgAcceleratorSegmentationMeta &placement );
+static DgAcceleratorMaskBuffer segmentationClassMap( const DgAcceleratorSegmentation &segmentation, size_t element_size );
+static void releaseSegmentationStatsMeta( gpointer data, gpointer user_data );
+static gpointer copySegmentationStatsMeta( gpointer data, gpointer user_data );
+void attachSegmentationStatsMetadata( NvDsFrameMeta *frameMeta,
+	const std::vector< DgAcceleratorClassStats > &stats,
+	const GstDgAcceleratorSegmentationMeta &placement );
+static void releaseSegmentationPolygonsMeta( gpointer data, gpointer user_data );
+static gpointer copySegmentationPolygonsMeta( gpointer data, gpointer user_data );
+GstDgAcceleratorSegmentationPolygonsMeta *attachSegmentationPolygonsMetadata( NvDsFrameMeta *frameMeta,
+	const std::vector< DgAcceleratorPolygon > &polygons,
+	const GstDgAcceleratorSegmentationMeta &placement );
+static void releasePoseMeta( gpointer data, gpointer user_data );
+static gpointer copyPoseMeta( gpointer data, gpointer user_data );
+void attachPoseMetadata( NvDsObjectMeta *objectMeta, guint64 frame_num, const GstDgAcceleratorPoseKeypoint *keypoints, guint num_keypoints );
 static GstFlowReturn get_converted_mat_2(
 	GstDgAccelerator *dgaccelerator,
 	NvBufSurface *input_buf,
@@ -156,6 +274,50 @@ static GType gst_dgaccelerator_box_color_get_type( void )
 	return dgaccelerator_box_color_type;
 }
 
+#define GST_TYPE_DGACCELERATOR_PROCESS_MODE ( gst_dgaccelerator_process_mode_get_type() )  //!< process mode get type function
+
+/// \brief Process mode get type function
+/// \return the process mode enum type
+static GType gst_dgaccelerator_process_mode_get_type( void )
+{
+	static GType dgaccelerator_process_mode_type = 0;
+	static const GEnumValue dgaccelerator_process_mode[] = {
+		{ DGACCELERATOR_PROCESS_MODE_PRIMARY, "Infer full frames", "primary" },
+		{ DGACCELERATOR_PROCESS_MODE_SECONDARY, "Infer objects detected upstream", "secondary" },
+		{ 0, NULL, NULL },
+	};
+
+	if( !dgaccelerator_process_mode_type )
+	{
+		dgaccelerator_process_mode_type = g_enum_register_static( "GstDgAcceleratorProcessMode", dgaccelerator_process_mode );
+	}
+	return dgaccelerator_process_mode_type;
+}
+
+#define GST_TYPE_DGACCELERATOR_SEGMENTATION_OUTPUT ( gst_dgaccelerator_segmentation_output_get_type() )  //!< segmentation output get type function
+
+/// \brief Segmentation output get type function
+/// \return the segmentation output enum type
+static GType gst_dgaccelerator_segmentation_output_get_type( void )
+{
+	static GType dgaccelerator_segmentation_output_type = 0;
+	static const GEnumValue dgaccelerator_segmentation_output[] = {
+		{ DGACCELERATOR_SEGMENTATION_OUTPUT_FRAME, "Class map upscaled to frame resolution", "frame" },
+		{ DGACCELERATOR_SEGMENTATION_OUTPUT_MODEL, "Class map at model resolution with scale info", "model" },
+		{ DGACCELERATOR_SEGMENTATION_OUTPUT_MODEL_UINT8, "uint8 class map at model resolution", "model-uint8" },
+		{ DGACCELERATOR_SEGMENTATION_OUTPUT_POLYGONS, "Polygons of the class regions", "polygons" },
+		{ DGACCELERATOR_SEGMENTATION_OUTPUT_NONE, "No class map", "none" },
+		{ 0, NULL, NULL },
+	};
+
+	if( !dgaccelerator_segmentation_output_type )
+	{
+		dgaccelerator_segmentation_output_type =
+			g_enum_register_static( "GstDgAcceleratorSegmentationOutput", dgaccelerator_segmentation_output );
+	}
+	return dgaccelerator_segmentation_output_type;
+}
+
 /// \brief Installs the object and BaseTransform properties along with pads
 /// \param[in] klass gstreamer boilerplate input class
 static void gst_dgaccelerator_class_init( GstDgAcceleratorClass *klass )
@@ -173,6 +335,7 @@ static void gst_dgaccelerator_class_init( GstDgAcceleratorClass *klass )
 	gstbasetransform_class = (GstBaseTransformClass *)klass;
 
 	// Overide base class functions
+	gobject_class->finalize = GST_DEBUG_FUNCPTR( gst_dgaccelerator_finalize );
 	gobject_class->set_property = GST_DEBUG_FUNCPTR( gst_dgaccelerator_set_property );
 	gobject_class->get_property = GST_DEBUG_FUNCPTR( gst_dgaccelerator_get_property );
 
@@ -228,7 +391,7 @@ static void gst_dgaccelerator_class_init( GstDgAcceleratorClass *klass )
 	g_object_class_install_property(
 		gobject_class,
 		PROP_SERVER_IP,
-		g_param_spec_string( "server_ip", "server_ip", "Full server IP", DEFAULT_SERVER_IP, G_PARAM_READWRITE ) );
+		g_param_spec_string( "server_ip", "server_ip", "Full server IP, or a comma separated list of servers to balance frames across", DEFAULT_SERVER_IP, G_PARAM_READWRITE ) );
 
 	g_object_class_install_property(
 		gobject_class,
@@ -378,6 +541,405 @@ static void gst_dgaccelerator_class_init( GstDgAcceleratorClass *klass )
 			DEFAULT_USE_REGULAR_NMS,
 			G_PARAM_READWRITE ) );
 
+	// built-in tracker property installation
+	g_object_class_install_property(
+		gobject_class,
+		PROP_TRACKER,
+		g_param_spec_boolean(
+			"tracker",
+			"Tracker",
+			"Track detected objects on the CPU, assigning stable object IDs and extrapolating boxes on frames without new results",
+			DEFAULT_TRACKER,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	g_object_class_install_property(
+		gobject_class,
+		PROP_TRACKER_IOU_THRESHOLD,
+		g_param_spec_double(
+			"tracker-iou-threshold",
+			"Tracker IoU Threshold",
+			"Minimum IoU between a predicted track and a detection to associate them",
+			0.0,
+			1.0,
+			DEFAULT_TRACKER_IOU_THRESHOLD,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	g_object_class_install_property(
+		gobject_class,
+		PROP_TRACKER_MAX_AGE,
+		g_param_spec_uint(
+			"tracker-max-age",
+			"Tracker Max Age",
+			"Number of frames a track is kept alive without a matching detection",
+			0,
+			G_MAXUINT,
+			DEFAULT_TRACKER_MAX_AGE,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	// motion gate property installation
+	g_object_class_install_property(
+		gobject_class,
+		PROP_MOTION_THRESHOLD,
+		g_param_spec_double(
+			"motion-threshold",
+			"Motion Threshold",
+			"Fraction of changed pixels below which a frame is not inferred and reuses the last results of its source. 0 disables the motion gate",
+			0.0,
+			1.0,
+			DEFAULT_MOTION_THRESHOLD,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	g_object_class_install_property(
+		gobject_class,
+		PROP_MOTION_PIXEL_THRESHOLD,
+		g_param_spec_uint(
+			"motion-pixel-threshold",
+			"Motion Pixel Threshold",
+			"Minimum intensity difference for a pixel to count as changed",
+			0,
+			255,
+			DEFAULT_MOTION_PIXEL_THRESHOLD,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	g_object_class_install_property(
+		gobject_class,
+		PROP_MOTION_MAX_SKIP,
+		g_param_spec_uint(
+			"motion-max-skip",
+			"Motion Max Skip",
+			"Maximum number of consecutive frames of a source held back by the motion gate",
+			0,
+			G_MAXUINT,
+			DEFAULT_MOTION_MAX_SKIP,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	// near-duplicate frame result cache property installation
+	g_object_class_install_property(
+		gobject_class,
+		PROP_DEDUP_CACHE_SIZE,
+		g_param_spec_uint(
+			"dedup-cache-size",
+			"Dedup Cache Size",
+			"Number of recent results kept per source for reuse by nearly identical frames. 0 disables the cache",
+			0,
+			64,
+			DEFAULT_DEDUP_CACHE_SIZE,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	g_object_class_install_property(
+		gobject_class,
+		PROP_DEDUP_HAMMING_THRESHOLD,
+		g_param_spec_uint(
+			"dedup-hamming-threshold",
+			"Dedup Hamming Threshold",
+			"Maximum number of differing bits between the 64-bit frame hashes of two frames considered duplicates",
+			0,
+			64,
+			DEFAULT_DEDUP_HAMMING_THRESHOLD,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	g_object_class_install_property(
+		gobject_class,
+		PROP_DEDUP_MAX_REUSE,
+		g_param_spec_uint(
+			"dedup-max-reuse",
+			"Dedup Max Reuse",
+			"Maximum number of frames served by one cached result before a matching frame is inferred again",
+			0,
+			G_MAXUINT,
+			DEFAULT_DEDUP_MAX_REUSE,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	// region of interest property installation
+	g_object_class_install_property(
+		gobject_class,
+		PROP_ROI,
+		g_param_spec_string(
+			"roi",
+			"Regions Of Interest",
+			"Per-source regions of interest inferred instead of the full frame, as source_id:left,top,width,height entries "
+			"separated by ';', in pixels of the batched frames (e.g. \"0:0,540,1920,540;2:640,0,1280,1080\")",
+			DEFAULT_ROI,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	// tiling property installation
+	g_object_class_install_property(
+		gobject_class,
+		PROP_TILING,
+		g_param_spec_boolean(
+			"tiling",
+			"Tiling",
+			"Infer each frame as overlapping tiles at processing resolution and merge the detections of all tiles",
+			DEFAULT_TILING,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	g_object_class_install_property(
+		gobject_class,
+		PROP_TILE_OVERLAP,
+		g_param_spec_double(
+			"tile-overlap",
+			"Tile Overlap",
+			"Minimum overlap between neighbouring tiles, as a fraction of the tile size",
+			0.0,
+			0.9,
+			DEFAULT_TILE_OVERLAP,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	g_object_class_install_property(
+		gobject_class,
+		PROP_TILE_NMS_THRESHOLD,
+		g_param_spec_double(
+			"tile-nms-threshold",
+			"Tile NMS Threshold",
+			"Overlap, relative to the smaller box, above which two detections of the same class from different tiles are merged",
+			0.0,
+			1.0,
+			DEFAULT_TILE_NMS_THRESHOLD,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	// secondary mode property installation
+	g_object_class_install_property(
+		gobject_class,
+		PROP_PROCESS_MODE,
+		g_param_spec_enum(
+			"process-mode",
+			"Process Mode",
+			"Infer full frames (primary), or the objects detected upstream (secondary)",
+			GST_TYPE_DGACCELERATOR_PROCESS_MODE,
+			DEFAULT_PROCESS_MODE,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	g_object_class_install_property(
+		gobject_class,
+		PROP_OPERATE_ON_CLASS_IDS,
+		g_param_spec_string(
+			"operate-on-class-ids",
+			"Operate On Class IDs",
+			"Secondary mode: class IDs of the upstream objects to infer, separated by ';'. Empty to infer all objects",
+			DEFAULT_OPERATE_ON_CLASS_IDS,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	g_object_class_install_property(
+		gobject_class,
+		PROP_INPUT_OBJECT_MIN_WIDTH,
+		g_param_spec_uint(
+			"input-object-min-width",
+			"Input Object Min Width",
+			"Secondary mode: minimum width of the upstream objects to infer, in pixels",
+			0,
+			G_MAXUINT,
+			DEFAULT_INPUT_OBJECT_MIN_WIDTH,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	g_object_class_install_property(
+		gobject_class,
+		PROP_INPUT_OBJECT_MIN_HEIGHT,
+		g_param_spec_uint(
+			"input-object-min-height",
+			"Input Object Min Height",
+			"Secondary mode: minimum height of the upstream objects to infer, in pixels",
+			0,
+			G_MAXUINT,
+			DEFAULT_INPUT_OBJECT_MIN_HEIGHT,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	g_object_class_install_property(
+		gobject_class,
+		PROP_SECONDARY_REINFER_INTERVAL,
+		g_param_spec_uint(
+			"secondary-reinfer-interval",
+			"Secondary Reinfer Interval",
+			"Secondary mode: number of frames during which the results of a tracked object are reused before it is inferred again. 0 infers objects on every frame",
+			0,
+			G_MAXUINT,
+			DEFAULT_REINFER_INTERVAL,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	// multi-model property installation
+	g_object_class_install_property(
+		gobject_class,
+		PROP_EXTRA_MODELS,
+		g_param_spec_string(
+			"extra-models",
+			"Extra Models",
+			"Additional models inferred on the same converted frames, as model_name[:width,height[,conf_threshold]] entries separated by ';'",
+			DEFAULT_EXTRA_MODELS,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	// connections property installation
+	g_object_class_install_property(
+		gobject_class,
+		PROP_CONNECTIONS,
+		g_param_spec_uint(
+			"connections",
+			"Connections",
+			"Number of model instances opened on each server, frames are spread across them to keep more requests in flight",
+			1,
+			16,
+			DEFAULT_CONNECTIONS,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	// reconnection property installation
+	g_object_class_install_property(
+		gobject_class,
+		PROP_RECONNECT,
+		g_param_spec_boolean(
+			"reconnect",
+			"Reconnect",
+			"Keep the pipeline running on server errors: frames are passed through without results while failed servers are reconnected in the background, and the remaining servers of server-ip take over",
+			DEFAULT_RECONNECT,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	g_object_class_install_property(
+		gobject_class,
+		PROP_RECONNECT_MAX_DELAY,
+		g_param_spec_uint(
+			"reconnect-max-delay",
+			"Reconnect Max Delay",
+			"Maximum delay between reconnection attempts to a failed server in milliseconds, the delay doubling from 500 ms after each failed attempt",
+			500,
+			3600000,
+			DEFAULT_RECONNECT_MAX_DELAY,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	// startup property installation
+	g_object_class_install_property(
+		gobject_class,
+		PROP_ASYNC_START,
+		g_param_spec_boolean(
+			"async-start",
+			"Async Start",
+			"Validate and connect the models on a background thread instead of blocking the state change, the first buffer waits for them",
+			DEFAULT_ASYNC_START,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	g_object_class_install_property(
+		gobject_class,
+		PROP_WARM_UP_FRAMES,
+		g_param_spec_uint(
+			"warm-up-frames",
+			"Warm Up Frames",
+			"Number of blank frames inferred by each model instance at startup, before the first buffer is processed",
+			0,
+			64,
+			DEFAULT_WARM_UP_FRAMES,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	// share-connection property installation
+	g_object_class_install_property(
+		gobject_class,
+		PROP_SHARE_CONNECTION,
+		g_param_spec_boolean(
+			"share-connection",
+			"Share Connection",
+			"Share the model instances with the other elements of the process using the same server, model and model parameters, each receiving the results of its own frames. Ignored with reconnect",
+			DEFAULT_SHARE_CONNECTION,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	// zoo-cache-dir property installation
+	g_object_class_install_property(
+		gobject_class,
+		PROP_ZOO_CACHE_DIR,
+		g_param_spec_string(
+			"zoo-cache-dir",
+			"Zoo Cache Dir",
+			"Existing directory where the model zoo listings of the servers are persisted, so that a cold start validates the model without waiting for the server. Empty to disable",
+			DEFAULT_ZOO_CACHE_DIR,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	// segmentation-output property installation
+	g_object_class_install_property(
+		gobject_class,
+		PROP_SEGMENTATION_OUTPUT,
+		g_param_spec_enum(
+			"segmentation-output",
+			"Segmentation Output",
+			"Attach segmentation class maps upscaled to frame resolution (frame), at model resolution with scale info (model), as a compact uint8 map at model resolution (model-uint8), as polygons of the class regions (polygons), or not at all (none)",
+			GST_TYPE_DGACCELERATOR_SEGMENTATION_OUTPUT,
+			DEFAULT_SEGMENTATION_OUTPUT,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	// segmentation-stats property installation
+	g_object_class_install_property(
+		gobject_class,
+		PROP_SEGMENTATION_STATS,
+		g_param_spec_boolean(
+			"segmentation-stats",
+			"Segmentation Stats",
+			"Attach the area, centroid and bounding box of each class of segmentation class maps as compact user meta",
+			DEFAULT_SEGMENTATION_STATS,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	// polygon-tolerance property installation
+	g_object_class_install_property(
+		gobject_class,
+		PROP_POLYGON_TOLERANCE,
+		g_param_spec_double(
+			"polygon-tolerance",
+			"Polygon Tolerance",
+			"With segmentation-output=polygons, the maximum distance between a region contour and its simplified polygon, in pixels of the model resolution class map",
+			0.0,
+			100.0,
+			DEFAULT_POLYGON_TOLERANCE,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	// draw property installation
+	g_object_class_install_property(
+		gobject_class,
+		PROP_DRAW,
+		g_param_spec_boolean(
+			"draw",
+			"Draw",
+			"Decorate results for nvdsosd with box borders, display text and display meta. When disabled, only the geometry, labels and confidences of the results are attached",
+			DEFAULT_DRAW,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	// result filter property installation
+	g_object_class_install_property(
+		gobject_class,
+		PROP_CLASS_FILTER,
+		g_param_spec_string(
+			"class-filter",
+			"Class Filter",
+			"Class IDs of the detections and classification results to attach, separated by ';'. Empty to attach all classes",
+			DEFAULT_CLASS_FILTER,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	g_object_class_install_property(
+		gobject_class,
+		PROP_MIN_CONFIDENCE,
+		g_param_spec_double(
+			"min-confidence",
+			"Min Confidence",
+			"Minimum confidence of the detections, poses and classification results to attach, applied on top of the model output threshold",
+			0.0,
+			1.0,
+			DEFAULT_MIN_CONFIDENCE,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	g_object_class_install_property(
+		gobject_class,
+		PROP_MIN_BOX_SIZE,
+		g_param_spec_uint(
+			"min-box-size",
+			"Min Box Size",
+			"Minimum width and height of the detections to attach, in pixels of the processing resolution",
+			0,
+			G_MAXUINT,
+			DEFAULT_MIN_BOX_SIZE,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
+	// share-frames property installation
+	g_object_class_install_property(
+		gobject_class,
+		PROP_SHARE_FRAMES,
+		g_param_spec_boolean(
+			"share-frames",
+			"Share Frames",
+			"Attach the frames converted at processing resolution to the buffer, for downstream dgaccelerator elements of the same processing resolution to reuse",
+			DEFAULT_SHARE_FRAMES,
+			(GParamFlags)( G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS ) ) );
+
 	// Set sink and src pad capabilities
 	gst_element_class_add_pad_template( gstelement_class, gst_static_pad_template_get( &gst_dgaccelerator_src_template ) );
 	gst_element_class_add_pad_template( gstelement_class, gst_static_pad_template_get( &gst_dgaccelerator_sink_template ) );
@@ -413,6 +975,7 @@ static void gst_dgaccelerator_init( GstDgAccelerator *dgaccelerator )
 	dgaccelerator->gpu_id = DEFAULT_GPU_ID;
 	dgaccelerator->model_name = const_cast< char * >( DEFAULT_MODEL_NAME );
 	dgaccelerator->server_ip = const_cast< char * >( DEFAULT_SERVER_IP );
+	dgaccelerator->swap_mutex = new std::mutex();
 	dgaccelerator->cloud_token = const_cast< char * >( DEFAULT_CLOUD_TOKEN );
 	dgaccelerator->box_color = DEFAULT_BOX_COLOR;
 	dgaccelerator->drop_frames = DEFAULT_DROP_FRAMES;
@@ -429,12 +992,97 @@ static void gst_dgaccelerator_init( GstDgAccelerator *dgaccelerator )
 	dgaccelerator->model_params.max_detections_per_class = DEFAULT_MAX_DETECTIONS_PER_CLASS;
 	dgaccelerator->model_params.max_classes_per_detection = DEFAULT_MAX_CLASSES_PER_DETECTION;
 	dgaccelerator->model_params.use_regular_nms = DEFAULT_USE_REGULAR_NMS;
+
+	// Initialize tracker property values
+	dgaccelerator->tracker_params.enable = DEFAULT_TRACKER;
+	dgaccelerator->tracker_params.iou_threshold = DEFAULT_TRACKER_IOU_THRESHOLD;
+	dgaccelerator->tracker_params.max_age = DEFAULT_TRACKER_MAX_AGE;
+
+	// Initialize motion gate property values
+	dgaccelerator->motion_params.threshold = DEFAULT_MOTION_THRESHOLD;
+	dgaccelerator->motion_params.pixel_threshold = DEFAULT_MOTION_PIXEL_THRESHOLD;
+	dgaccelerator->motion_params.max_skip = DEFAULT_MOTION_MAX_SKIP;
+
+	// Initialize result cache property values
+	dgaccelerator->dedup_params.cache_size = DEFAULT_DEDUP_CACHE_SIZE;
+	dgaccelerator->dedup_params.hamming_threshold = DEFAULT_DEDUP_HAMMING_THRESHOLD;
+	dgaccelerator->dedup_params.max_reuse = DEFAULT_DEDUP_MAX_REUSE;
+
+	// Initialize region of interest property value
+	dgaccelerator->roi = const_cast< char * >( DEFAULT_ROI );
+	dgaccelerator->roi_map = NULL;
+
+	// Initialize tiling property values
+	dgaccelerator->tiling_params.enable = DEFAULT_TILING;
+	dgaccelerator->tiling_params.overlap = DEFAULT_TILE_OVERLAP;
+	dgaccelerator->tiling_params.nms_threshold = DEFAULT_TILE_NMS_THRESHOLD;
+
+	// Initialize secondary mode property values
+	dgaccelerator->process_mode = DEFAULT_PROCESS_MODE;
+	dgaccelerator->secondary_params.operate_on_class_ids = const_cast< char * >( DEFAULT_OPERATE_ON_CLASS_IDS );
+	dgaccelerator->secondary_params.min_width = DEFAULT_INPUT_OBJECT_MIN_WIDTH;
+	dgaccelerator->secondary_params.min_height = DEFAULT_INPUT_OBJECT_MIN_HEIGHT;
+	dgaccelerator->secondary_params.reinfer_interval = DEFAULT_REINFER_INTERVAL;
+	dgaccelerator->class_ids = NULL;
+
+	// Initialize multi-model property values
+	dgaccelerator->extra_models = const_cast< char * >( DEFAULT_EXTRA_MODELS );
+	dgaccelerator->model_list = NULL;
+
+	// Initialize connections property value
+	dgaccelerator->connections = DEFAULT_CONNECTIONS;
+
+	// Initialize reconnection property values
+	dgaccelerator->reconnect_params.enable = DEFAULT_RECONNECT;
+	dgaccelerator->reconnect_params.max_delay = DEFAULT_RECONNECT_MAX_DELAY;
+
+	// Initialize startup property values
+	dgaccelerator->async_start = DEFAULT_ASYNC_START;
+	dgaccelerator->warm_up_frames = DEFAULT_WARM_UP_FRAMES;
+
+	// Initialize share-connection property value
+	dgaccelerator->share_connection = DEFAULT_SHARE_CONNECTION;
+
+	// Initialize zoo-cache-dir property value
+	dgaccelerator->zoo_cache_dir = const_cast< char * >( DEFAULT_ZOO_CACHE_DIR );
+
+	// Initialize segmentation-output property value
+	dgaccelerator->segmentation_output = DEFAULT_SEGMENTATION_OUTPUT;
+
+	// Initialize segmentation-stats property value
+	dgaccelerator->segmentation_stats = DEFAULT_SEGMENTATION_STATS;
+
+	// Initialize polygon-tolerance property value
+	dgaccelerator->polygon_tolerance = DEFAULT_POLYGON_TOLERANCE;
+
+	// Initialize draw property value
+	dgaccelerator->draw = DEFAULT_DRAW;
+
+	// Initialize result filter property values
+	dgaccelerator->filter_params.class_filter = const_cast< char * >( DEFAULT_CLASS_FILTER );
+	dgaccelerator->filter_params.min_confidence = DEFAULT_MIN_CONFIDENCE;
+	dgaccelerator->filter_params.min_box_size = DEFAULT_MIN_BOX_SIZE;
+	dgaccelerator->class_filter_ids = NULL;
+
+	// Initialize share-frames property value
+	dgaccelerator->share_frames = DEFAULT_SHARE_FRAMES;
 	// This quark is required to identify NvDsMeta when iterating through
 	// the buffer metadatas
 	if( !_dsmeta_quark )
 		_dsmeta_quark = g_quark_from_static_string( NVDS_META_STRING );
 }
 
+///
+/// \brief Frees the GstDgAccelerator object
+/// \param[in] object Pointer to the GObject instance of GstDgAccelerator
+///
+static void gst_dgaccelerator_finalize( GObject *object )
+{
+	GstDgAccelerator *dgaccelerator = GST_DGACCELERATOR( object );
+	delete dgaccelerator->swap_mutex;
+	G_OBJECT_CLASS( parent_class )->finalize( object );
+}
+
 ///
 /// \brief Sets the value of the specified property for the GstDgAccelerator object
 ///
@@ -474,8 +1122,7 @@ static void gst_dgaccelerator_set_property( GObject *object, guint prop_id, cons
 			G_OBJECT_WARN_INVALID_PROPERTY_ID( object, prop_id, pspec );
 			break;
 		}
-		dgaccelerator->model_name = new char[ strlen( g_value_get_string( value ) ) + 1 ];
-		strcpy( dgaccelerator->model_name, g_value_get_string( value ) );
+		model_string_set( dgaccelerator, dgaccelerator->model_name, dgaccelerator->swap_model_name, g_value_get_string( value ) );
 		break;
 	case PROP_SERVER_IP:
 		// Don't allow >128 characters!
@@ -485,8 +1132,7 @@ static void gst_dgaccelerator_set_property( GObject *object, guint prop_id, cons
 			G_OBJECT_WARN_INVALID_PROPERTY_ID( object, prop_id, pspec );
 			break;
 		}
-		dgaccelerator->server_ip = new char[ strlen( g_value_get_string( value ) ) + 1 ];
-		strcpy( dgaccelerator->server_ip, g_value_get_string( value ) );
+		model_string_set( dgaccelerator, dgaccelerator->server_ip, dgaccelerator->swap_server_ip, g_value_get_string( value ) );
 		break;
 	case PROP_CLOUD_TOKEN:
 		// Don't allow > 128 characters!
@@ -551,30 +1197,137 @@ static void gst_dgaccelerator_set_property( GObject *object, guint prop_id, cons
     case PROP_USE_REGULAR_NMS:
         dgaccelerator->model_params.use_regular_nms = g_value_get_boolean( value );
         break;
-	default:
-		G_OBJECT_WARN_INVALID_PROPERTY_ID( object, prop_id, pspec );
+	case PROP_TRACKER:
+		dgaccelerator->tracker_params.enable = g_value_get_boolean( value );
 		break;
-	}
-}
-
-///
-/// \brief Retrieves the value of the specified property for the GstDgAccelerator object
-///
-/// This function is called when a property value is requested for the GstDgAccelerator object. It takes
-/// in the property ID and property specification, and returns the value of the corresponding property
-/// through the GValue parameter.
-///
-/// \param[in] object Pointer to the GObject instance of GstDgAccelerator
-/// \param[in] prop_id The ID of the property to retrieve
-/// \param[out] value The retrieved value of the property
-/// \param[in] pspec The GParamSpec of the property
-///
-static void gst_dgaccelerator_get_property( GObject *object, guint prop_id, GValue *value, GParamSpec *pspec )
-{
-	GstDgAccelerator *dgaccelerator = GST_DGACCELERATOR( object );
-
-	switch( prop_id )
-	{
+	case PROP_TRACKER_IOU_THRESHOLD:
+		dgaccelerator->tracker_params.iou_threshold = g_value_get_double( value );
+		break;
+	case PROP_TRACKER_MAX_AGE:
+		dgaccelerator->tracker_params.max_age = g_value_get_uint( value );
+		break;
+	case PROP_MOTION_THRESHOLD:
+		dgaccelerator->motion_params.threshold = g_value_get_double( value );
+		break;
+	case PROP_MOTION_PIXEL_THRESHOLD:
+		dgaccelerator->motion_params.pixel_threshold = g_value_get_uint( value );
+		break;
+	case PROP_MOTION_MAX_SKIP:
+		dgaccelerator->motion_params.max_skip = g_value_get_uint( value );
+		break;
+	case PROP_DEDUP_CACHE_SIZE:
+		dgaccelerator->dedup_params.cache_size = g_value_get_uint( value );
+		break;
+	case PROP_DEDUP_HAMMING_THRESHOLD:
+		dgaccelerator->dedup_params.hamming_threshold = g_value_get_uint( value );
+		break;
+	case PROP_DEDUP_MAX_REUSE:
+		dgaccelerator->dedup_params.max_reuse = g_value_get_uint( value );
+		break;
+	case PROP_ROI:
+		dgaccelerator->roi = new char[ strlen( g_value_get_string( value ) ) + 1 ];
+		strcpy( dgaccelerator->roi, g_value_get_string( value ) );
+		break;
+	case PROP_TILING:
+		dgaccelerator->tiling_params.enable = g_value_get_boolean( value );
+		break;
+	case PROP_TILE_OVERLAP:
+		dgaccelerator->tiling_params.overlap = g_value_get_double( value );
+		break;
+	case PROP_TILE_NMS_THRESHOLD:
+		dgaccelerator->tiling_params.nms_threshold = g_value_get_double( value );
+		break;
+	case PROP_PROCESS_MODE:
+		dgaccelerator->process_mode = (GstDgAcceleratorProcessMode)g_value_get_enum( value );
+		break;
+	case PROP_OPERATE_ON_CLASS_IDS:
+		dgaccelerator->secondary_params.operate_on_class_ids = new char[ strlen( g_value_get_string( value ) ) + 1 ];
+		strcpy( dgaccelerator->secondary_params.operate_on_class_ids, g_value_get_string( value ) );
+		break;
+	case PROP_INPUT_OBJECT_MIN_WIDTH:
+		dgaccelerator->secondary_params.min_width = g_value_get_uint( value );
+		break;
+	case PROP_INPUT_OBJECT_MIN_HEIGHT:
+		dgaccelerator->secondary_params.min_height = g_value_get_uint( value );
+		break;
+	case PROP_SECONDARY_REINFER_INTERVAL:
+		dgaccelerator->secondary_params.reinfer_interval = g_value_get_uint( value );
+		break;
+	case PROP_EXTRA_MODELS:
+		dgaccelerator->extra_models = new char[ strlen( g_value_get_string( value ) ) + 1 ];
+		strcpy( dgaccelerator->extra_models, g_value_get_string( value ) );
+		break;
+	case PROP_CONNECTIONS:
+		dgaccelerator->connections = g_value_get_uint( value );
+		break;
+	case PROP_RECONNECT:
+		dgaccelerator->reconnect_params.enable = g_value_get_boolean( value );
+		break;
+	case PROP_RECONNECT_MAX_DELAY:
+		dgaccelerator->reconnect_params.max_delay = g_value_get_uint( value );
+		break;
+	case PROP_ASYNC_START:
+		dgaccelerator->async_start = g_value_get_boolean( value );
+		break;
+	case PROP_WARM_UP_FRAMES:
+		dgaccelerator->warm_up_frames = g_value_get_uint( value );
+		break;
+	case PROP_SHARE_CONNECTION:
+		dgaccelerator->share_connection = g_value_get_boolean( value );
+		break;
+	case PROP_ZOO_CACHE_DIR:
+		dgaccelerator->zoo_cache_dir = new char[ strlen( g_value_get_string( value ) ) + 1 ];
+		strcpy( dgaccelerator->zoo_cache_dir, g_value_get_string( value ) );
+		break;
+	case PROP_SEGMENTATION_OUTPUT:
+		dgaccelerator->segmentation_output = (GstDgAcceleratorSegmentationOutput)g_value_get_enum( value );
+		break;
+	case PROP_SEGMENTATION_STATS:
+		dgaccelerator->segmentation_stats = g_value_get_boolean( value );
+		break;
+	case PROP_POLYGON_TOLERANCE:
+		dgaccelerator->polygon_tolerance = g_value_get_double( value );
+		break;
+	case PROP_DRAW:
+		dgaccelerator->draw = g_value_get_boolean( value );
+		break;
+	case PROP_CLASS_FILTER:
+		dgaccelerator->filter_params.class_filter = new char[ strlen( g_value_get_string( value ) ) + 1 ];
+		strcpy( dgaccelerator->filter_params.class_filter, g_value_get_string( value ) );
+		break;
+	case PROP_MIN_CONFIDENCE:
+		dgaccelerator->filter_params.min_confidence = g_value_get_double( value );
+		break;
+	case PROP_MIN_BOX_SIZE:
+		dgaccelerator->filter_params.min_box_size = g_value_get_uint( value );
+		break;
+	case PROP_SHARE_FRAMES:
+		dgaccelerator->share_frames = g_value_get_boolean( value );
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID( object, prop_id, pspec );
+		break;
+	}
+}
+
+///
+/// \brief Retrieves the value of the specified property for the GstDgAccelerator object
+///
+/// This function is called when a property value is requested for the GstDgAccelerator object. It takes
+/// in the property ID and property specification, and returns the value of the corresponding property
+/// through the GValue parameter.
+///
+/// \param[in] object Pointer to the GObject instance of GstDgAccelerator
+/// \param[in] prop_id The ID of the property to retrieve
+/// \param[out] value The retrieved value of the property
+/// \param[in] pspec The GParamSpec of the property
+///
+static void gst_dgaccelerator_get_property( GObject *object, guint prop_id, GValue *value, GParamSpec *pspec )
+{
+	GstDgAccelerator *dgaccelerator = GST_DGACCELERATOR( object );
+
+	switch( prop_id )
+	{
 	case PROP_UNIQUE_ID:
 		g_value_set_uint( value, dgaccelerator->unique_id );
 		break;
@@ -591,11 +1344,17 @@ static void gst_dgaccelerator_get_property( GObject *object, guint prop_id, GVal
 		g_value_set_enum( value, dgaccelerator->box_color );
 		break;
 	case PROP_MODEL_NAME:
-		g_value_set_string( value, dgaccelerator->model_name );
+	{
+		std::lock_guard< std::mutex > lock( *dgaccelerator->swap_mutex );
+		g_value_set_string( value, dgaccelerator->swap_model_name ? dgaccelerator->swap_model_name : dgaccelerator->model_name );
 		break;
+	}
 	case PROP_SERVER_IP:
-		g_value_set_string( value, dgaccelerator->server_ip );
+	{
+		std::lock_guard< std::mutex > lock( *dgaccelerator->swap_mutex );
+		g_value_set_string( value, dgaccelerator->swap_server_ip ? dgaccelerator->swap_server_ip : dgaccelerator->server_ip );
 		break;
+	}
 	case PROP_CLOUD_TOKEN:
 		g_value_set_string( value, dgaccelerator->cloud_token );
 		break;
@@ -635,6 +1394,108 @@ static void gst_dgaccelerator_get_property( GObject *object, guint prop_id, GVal
     case PROP_USE_REGULAR_NMS:
         g_value_set_boolean( value, dgaccelerator->model_params.use_regular_nms );
         break;
+	case PROP_TRACKER:
+		g_value_set_boolean( value, dgaccelerator->tracker_params.enable );
+		break;
+	case PROP_TRACKER_IOU_THRESHOLD:
+		g_value_set_double( value, dgaccelerator->tracker_params.iou_threshold );
+		break;
+	case PROP_TRACKER_MAX_AGE:
+		g_value_set_uint( value, dgaccelerator->tracker_params.max_age );
+		break;
+	case PROP_MOTION_THRESHOLD:
+		g_value_set_double( value, dgaccelerator->motion_params.threshold );
+		break;
+	case PROP_MOTION_PIXEL_THRESHOLD:
+		g_value_set_uint( value, dgaccelerator->motion_params.pixel_threshold );
+		break;
+	case PROP_MOTION_MAX_SKIP:
+		g_value_set_uint( value, dgaccelerator->motion_params.max_skip );
+		break;
+	case PROP_DEDUP_CACHE_SIZE:
+		g_value_set_uint( value, dgaccelerator->dedup_params.cache_size );
+		break;
+	case PROP_DEDUP_HAMMING_THRESHOLD:
+		g_value_set_uint( value, dgaccelerator->dedup_params.hamming_threshold );
+		break;
+	case PROP_DEDUP_MAX_REUSE:
+		g_value_set_uint( value, dgaccelerator->dedup_params.max_reuse );
+		break;
+	case PROP_ROI:
+		g_value_set_string( value, dgaccelerator->roi );
+		break;
+	case PROP_TILING:
+		g_value_set_boolean( value, dgaccelerator->tiling_params.enable );
+		break;
+	case PROP_TILE_OVERLAP:
+		g_value_set_double( value, dgaccelerator->tiling_params.overlap );
+		break;
+	case PROP_TILE_NMS_THRESHOLD:
+		g_value_set_double( value, dgaccelerator->tiling_params.nms_threshold );
+		break;
+	case PROP_PROCESS_MODE:
+		g_value_set_enum( value, dgaccelerator->process_mode );
+		break;
+	case PROP_OPERATE_ON_CLASS_IDS:
+		g_value_set_string( value, dgaccelerator->secondary_params.operate_on_class_ids );
+		break;
+	case PROP_INPUT_OBJECT_MIN_WIDTH:
+		g_value_set_uint( value, dgaccelerator->secondary_params.min_width );
+		break;
+	case PROP_INPUT_OBJECT_MIN_HEIGHT:
+		g_value_set_uint( value, dgaccelerator->secondary_params.min_height );
+		break;
+	case PROP_SECONDARY_REINFER_INTERVAL:
+		g_value_set_uint( value, dgaccelerator->secondary_params.reinfer_interval );
+		break;
+	case PROP_EXTRA_MODELS:
+		g_value_set_string( value, dgaccelerator->extra_models );
+		break;
+	case PROP_CONNECTIONS:
+		g_value_set_uint( value, dgaccelerator->connections );
+		break;
+	case PROP_RECONNECT:
+		g_value_set_boolean( value, dgaccelerator->reconnect_params.enable );
+		break;
+	case PROP_RECONNECT_MAX_DELAY:
+		g_value_set_uint( value, dgaccelerator->reconnect_params.max_delay );
+		break;
+	case PROP_ASYNC_START:
+		g_value_set_boolean( value, dgaccelerator->async_start );
+		break;
+	case PROP_WARM_UP_FRAMES:
+		g_value_set_uint( value, dgaccelerator->warm_up_frames );
+		break;
+	case PROP_SHARE_CONNECTION:
+		g_value_set_boolean( value, dgaccelerator->share_connection );
+		break;
+	case PROP_ZOO_CACHE_DIR:
+		g_value_set_string( value, dgaccelerator->zoo_cache_dir );
+		break;
+	case PROP_SEGMENTATION_OUTPUT:
+		g_value_set_enum( value, dgaccelerator->segmentation_output );
+		break;
+	case PROP_SEGMENTATION_STATS:
+		g_value_set_boolean( value, dgaccelerator->segmentation_stats );
+		break;
+	case PROP_POLYGON_TOLERANCE:
+		g_value_set_double( value, dgaccelerator->polygon_tolerance );
+		break;
+	case PROP_DRAW:
+		g_value_set_boolean( value, dgaccelerator->draw );
+		break;
+	case PROP_CLASS_FILTER:
+		g_value_set_string( value, dgaccelerator->filter_params.class_filter );
+		break;
+	case PROP_MIN_CONFIDENCE:
+		g_value_set_double( value, dgaccelerator->filter_params.min_confidence );
+		break;
+	case PROP_MIN_BOX_SIZE:
+		g_value_set_uint( value, dgaccelerator->filter_params.min_box_size );
+		break;
+	case PROP_SHARE_FRAMES:
+		g_value_set_boolean( value, dgaccelerator->share_frames );
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID( object, prop_id, pspec );
 		break;
@@ -675,8 +1536,74 @@ static gboolean gst_dgaccelerator_start( GstBaseTransform *btrans )
 	}
 	gst_query_unref( queryparams );
 
-	// Initialize our context with the parameters
-	dgaccelerator->dgacceleratorlib_ctx = DgAcceleratorCtxInit( dgaccelerator );
+	// Parse the regions of interest, checked before connecting to the server
+	dgaccelerator->roi_map = new std::map< guint, NvOSD_RectParams >();
+	if( !parse_roi( dgaccelerator->roi, *dgaccelerator->roi_map ) )
+	{
+		GST_ELEMENT_ERROR( dgaccelerator, LIBRARY, SETTINGS, ( "Invalid roi property: '%s'", dgaccelerator->roi ), ( NULL ) );
+		delete dgaccelerator->roi_map;
+		dgaccelerator->roi_map = NULL;
+		return FALSE;
+	}
+	dgaccelerator->class_ids = new std::set< gint >();
+	if( !parse_class_ids( dgaccelerator->secondary_params.operate_on_class_ids, *dgaccelerator->class_ids ) )
+	{
+		GST_ELEMENT_ERROR(
+			dgaccelerator, LIBRARY, SETTINGS, ( "Invalid operate-on-class-ids property: '%s'", dgaccelerator->secondary_params.operate_on_class_ids ), ( NULL ) );
+		delete dgaccelerator->class_ids;
+		dgaccelerator->class_ids = NULL;
+		return FALSE;
+	}
+	dgaccelerator->class_filter_ids = new std::set< gint >();
+	if( !parse_class_ids( dgaccelerator->filter_params.class_filter, *dgaccelerator->class_filter_ids ) )
+	{
+		GST_ELEMENT_ERROR( dgaccelerator, LIBRARY, SETTINGS, ( "Invalid class-filter property: '%s'", dgaccelerator->filter_params.class_filter ), ( NULL ) );
+		delete dgaccelerator->class_filter_ids;
+		dgaccelerator->class_filter_ids = NULL;
+		return FALSE;
+	}
+	dgaccelerator->model_list = new std::vector< GstDgAcceleratorModel >();
+	if( !parse_extra_models(
+			dgaccelerator->extra_models, dgaccelerator->processing_width, dgaccelerator->processing_height, *dgaccelerator->model_list ) )
+	{
+		GST_ELEMENT_ERROR( dgaccelerator, LIBRARY, SETTINGS, ( "Invalid extra-models property: '%s'", dgaccelerator->extra_models ), ( NULL ) );
+		free_extra_models( dgaccelerator );
+		return FALSE;
+	}
+	if( !dgaccelerator->model_list->empty() &&
+		( dgaccelerator->tiling_params.enable || dgaccelerator->process_mode != DGACCELERATOR_PROCESS_MODE_PRIMARY ) )
+	{
+		GST_ELEMENT_ERROR( dgaccelerator, LIBRARY, SETTINGS, ( "extra-models is only supported in primary mode without tiling" ), ( NULL ) );
+		free_extra_models( dgaccelerator );
+		return FALSE;
+	}
+
+	// From now on, model-name and server_ip set by the application are swapped in by the streaming thread
+	{
+		std::lock_guard< std::mutex > lock( *dgaccelerator->swap_mutex );
+		dgaccelerator->models_started = TRUE;
+	}
+
+	// Initialize our context with the parameters, in the background with async-start so that the state change does
+	// not wait for the server round trips. The streaming thread waits for the models before processing buffers.
+	if( dgaccelerator->async_start )
+	{
+		dgaccelerator->init_error = new std::string();
+		dgaccelerator->init_thread = new std::thread( [ dgaccelerator ]() {
+			try
+			{
+				init_models( dgaccelerator );
+			}
+			catch( const std::exception &e )
+			{
+				*dgaccelerator->init_error = e.what();
+			}
+		} );
+	}
+	else
+		init_models( dgaccelerator );
+	dgaccelerator->swap_ctx = new std::atomic< GstDgAcceleratorSwap * >( nullptr );
+	dgaccelerator->swap_building = new std::atomic< bool >( false );
 
 	CHECK_CUDA_STATUS( cudaStreamCreate( &dgaccelerator->cuda_stream ), "Could not create cuda stream" );
 
@@ -762,8 +1689,20 @@ error:
 		cudaStreamDestroy( dgaccelerator->cuda_stream );
 		dgaccelerator->cuda_stream = NULL;
 	}
+	// Wait for the models initialized in the background before freeing them
+	if( dgaccelerator->init_thread )
+	{
+		dgaccelerator->init_thread->join();
+		delete dgaccelerator->init_thread;
+		dgaccelerator->init_thread = NULL;
+	}
+	delete dgaccelerator->init_error;
+	dgaccelerator->init_error = NULL;
+	model_swap_stop( dgaccelerator );
 	if( dgaccelerator->dgacceleratorlib_ctx )
 		DgAcceleratorCtxDeinit( dgaccelerator->dgacceleratorlib_ctx );
+	dgaccelerator->dgacceleratorlib_ctx = NULL;
+	free_extra_models( dgaccelerator );
 
 	return FALSE;
 }
@@ -793,15 +1732,36 @@ static gboolean gst_dgaccelerator_stop( GstBaseTransform *btrans )
 	delete dgaccelerator->cvmat;
 	dgaccelerator->cvmat = NULL;
 
+	delete dgaccelerator->roi_map;
+	dgaccelerator->roi_map = NULL;
+
+	delete dgaccelerator->class_ids;
+	dgaccelerator->class_ids = NULL;
+	delete dgaccelerator->class_filter_ids;
+	dgaccelerator->class_filter_ids = NULL;
+
 	if( dgaccelerator->host_rgb_buf )
 	{
 		cudaFreeHost( dgaccelerator->host_rgb_buf );
 		dgaccelerator->host_rgb_buf = NULL;
 	}
 
+	// Wait for the models initialized in the background
+	if( dgaccelerator->init_thread )
+	{
+		dgaccelerator->init_thread->join();
+		delete dgaccelerator->init_thread;
+		dgaccelerator->init_thread = NULL;
+	}
+	delete dgaccelerator->init_error;
+	dgaccelerator->init_error = NULL;
+
 	// Deinitialize our library
-	DgAcceleratorCtxDeinit( dgaccelerator->dgacceleratorlib_ctx );
+	model_swap_stop( dgaccelerator );
+	if( dgaccelerator->dgacceleratorlib_ctx )
+		DgAcceleratorCtxDeinit( dgaccelerator->dgacceleratorlib_ctx );
 	dgaccelerator->dgacceleratorlib_ctx = NULL;
+	free_extra_models( dgaccelerator );
 
 	return TRUE;
 }
@@ -823,6 +1783,11 @@ static gboolean gst_dgaccelerator_set_caps( GstBaseTransform *btrans, GstCaps *i
 	GstDgAccelerator *dgaccelerator = GST_DGACCELERATOR( btrans );
 	// Save the input video information
 	gst_video_info_from_caps( &dgaccelerator->video_info, incaps );
+	if( !init_wait( dgaccelerator ) )
+		goto error;
+	// Tile layouts depend on the frame size
+	if( dgaccelerator->tiling_params.enable && dgaccelerator->process_mode == DGACCELERATOR_PROCESS_MODE_PRIMARY )
+		DgAcceleratorTilingSet( dgaccelerator->dgacceleratorlib_ctx, dgaccelerator->video_info.width, dgaccelerator->video_info.height );
 
 	return TRUE;
 
@@ -1000,9 +1965,20 @@ static GstFlowReturn gst_dgaccelerator_transform_ip( GstBaseTransform *btrans, G
 	NvDsMetaList *l_frame = NULL;
 	guint i = 0;  // frame number in the batch
 
+	// Frames converted by an upstream dgaccelerator of the same processing resolution, or shared by this element
+	GstDgAcceleratorFrameMeta *shared_meta = NULL;
+	gboolean own_meta = FALSE;
+	std::shared_ptr< DgAcceleratorSharedFrame > frame;
+
 	dgaccelerator->frame_num++;
 	CHECK_CUDA_STATUS( cudaSetDevice( dgaccelerator->gpu_id ), "Unable to set cuda device" );
 
+	if( !init_wait( dgaccelerator ) )
+		return GST_FLOW_ERROR;
+	// Build the model set requested in PLAYING state, and switch to it once it is warmed up
+	model_swap_request( dgaccelerator );
+	model_swap_apply( dgaccelerator );
+
 	// maps the input buffer to get the input NvBufSurface.
 	memset( &in_map_info, 0, sizeof( in_map_info ) );
 	if( !gst_buffer_map( inbuf, &in_map_info, GST_MAP_READ ) )
@@ -1027,6 +2003,24 @@ static GstFlowReturn gst_dgaccelerator_transform_ip( GstBaseTransform *btrans, G
 		return GST_FLOW_ERROR;
 	}
 
+	// Secondary mode: objects detected upstream are inferred instead of full frames
+	if( dgaccelerator->process_mode == DGACCELERATOR_PROCESS_MODE_SECONDARY )
+	{
+		flow_ret = process_objects( dgaccelerator, surface, batch_meta );
+		goto error;  // Common exit
+	}
+
+	if( !dgaccelerator->tiling_params.enable )
+	{
+		shared_meta = gst_dgaccelerator_frame_meta_get( inbuf, dgaccelerator->processing_width, dgaccelerator->processing_height, FALSE );
+		// Only the element which attached the meta adds frames to it, as elements in other branches may be reading it
+		if( shared_meta == NULL && dgaccelerator->share_frames )
+		{
+			shared_meta = gst_dgaccelerator_frame_meta_get( inbuf, dgaccelerator->processing_width, dgaccelerator->processing_height, TRUE );
+			own_meta = TRUE;
+		}
+	}
+
 	// sets the scaling parameters for the frame and scales and converts the
 	// frame using the get_converted_mat function
 	for( l_frame = batch_meta->frame_meta_list; l_frame != NULL; l_frame = l_frame->next )
@@ -1040,17 +2034,100 @@ static GstFlowReturn gst_dgaccelerator_transform_ip( GstBaseTransform *btrans, G
 		rect_params.width = dgaccelerator->video_info.width;
 		rect_params.height = dgaccelerator->video_info.height;
 
-		if( get_converted_mat_2( dgaccelerator, surface, i, &rect_params, dgaccelerator->video_info.width, dgaccelerator->video_info.height ) !=
-			GST_FLOW_OK )
+		// Or only the region of interest of the source, clipped to the frame
+		auto roi = dgaccelerator->roi_map->find( frame_meta->source_id );
+		if( roi != dgaccelerator->roi_map->end() )
+		{
+			rect_params.left = std::min( roi->second.left, (float)dgaccelerator->video_info.width - 2 );
+			rect_params.top = std::min( roi->second.top, (float)dgaccelerator->video_info.height - 2 );
+			rect_params.width = std::min( roi->second.width, dgaccelerator->video_info.width - rect_params.left );
+			rect_params.height = std::min( roi->second.height, dgaccelerator->video_info.height - rect_params.top );
+		}
+
+		if( dgaccelerator->tiling_params.enable )
+		{
+			// Tiling mode: convert and submit each tile of the region, output holds the merged detections
+			output = DgAcceleratorProcessTiled(
+				dgaccelerator->dgacceleratorlib_ctx,
+				rect_params.width,
+				rect_params.height,
+				frame_meta->source_id,
+				[ & ]( const DgAcceleratorTile &tile ) -> unsigned char * {
+					NvOSD_RectParams tile_params = rect_params;
+					tile_params.left += tile.left;
+					tile_params.top += tile.top;
+					tile_params.width = tile.width;
+					tile_params.height = tile.height;
+					if( get_converted_mat_2( dgaccelerator, surface, i, &tile_params, dgaccelerator->video_info.width, dgaccelerator->video_info.height ) !=
+						GST_FLOW_OK )
+						return NULL;
+					return dgaccelerator->cvmat->data;
+				} );
+			if( output == nullptr )
+				goto error;
+		}
+		else
 		{
-			goto error;
+			// Reuse the frame if an upstream dgaccelerator converted the same region, or convert it and share it if enabled
+			frame = nullptr;
+			if( shared_meta != NULL )
+				frame = gst_dgaccelerator_frame_meta_lookup( shared_meta, i, rect_params.left, rect_params.top, rect_params.width, rect_params.height );
+			if( !frame )
+			{
+				if( get_converted_mat_2( dgaccelerator, surface, i, &rect_params, dgaccelerator->video_info.width, dgaccelerator->video_info.height ) !=
+					GST_FLOW_OK )
+				{
+					goto error;
+				}
+				frame = std::make_shared< DgAcceleratorSharedFrame >();
+				frame->left = rect_params.left;
+				frame->top = rect_params.top;
+				frame->width = rect_params.width;
+				frame->height = rect_params.height;
+				if( own_meta )
+				{
+					// The converted mat is overwritten by the next frame, so shared frames hold a copy
+					frame->bgr = dgaccelerator->cvmat->clone();
+					if( shared_meta->frames->size() <= i )
+						shared_meta->frames->resize( i + 1 );
+					( *shared_meta->frames )[ i ] = frame;
+				}
+				else
+				{
+					frame->bgr = *dgaccelerator->cvmat;
+				}
+			}
+			// processes the frame using the DgAcceleratorProcess function
+			// Output is a DgAcceleratorOutput object!
+			output = DgAcceleratorProcess( dgaccelerator->dgacceleratorlib_ctx, frame->bgr.data, frame_meta->source_id, &frame->encoded );
 		}
-		// processes the frame using the DgAcceleratorProcess function and attaches
-		// the metadata for the full frame
-		// Output is a DgAcceleratorOutput object!
-		output = DgAcceleratorProcess( dgaccelerator->dgacceleratorlib_ctx, dgaccelerator->cvmat->data );
 		// Attach the metadata for the full frame
-		attach_metadata_full_frame( dgaccelerator, frame_meta, scale_ratio, output, i );
+		attach_metadata_full_frame(
+			dgaccelerator,
+			dgaccelerator->dgacceleratorlib_ctx,
+			dgaccelerator->processing_width,
+			dgaccelerator->processing_height,
+			frame_meta,
+			scale_ratio,
+			output,
+			i,
+			&rect_params );
+
+		// Additional models reuse the converted frame, resized once per resolution, and its encodings
+		for( size_t m = 0; m < dgaccelerator->model_list->size(); m++ )
+		{
+			GstDgAcceleratorModel &model = ( *dgaccelerator->model_list )[ m ];
+			unsigned char *data = frame->bgr.data;
+			if( model.frame >= 0 )
+			{
+				GstDgAcceleratorModel &owner = ( *dgaccelerator->model_list )[ model.frame ];
+				if( model.frame == (gint)m )
+					cv::resize( frame->bgr, *owner.cvmat, owner.cvmat->size(), 0, 0, cv::INTER_AREA );
+				data = owner.cvmat->data;
+			}
+			output = DgAcceleratorProcess( model.ctx, data, frame_meta->source_id, &frame->encoded );
+			attach_metadata_full_frame( dgaccelerator, model.ctx, model.width, model.height, frame_meta, scale_ratio, output, i, &rect_params );
+		}
 		i++;
 	}
 
@@ -1062,6 +2139,133 @@ error:
 	return flow_ret;
 }
 
+///
+/// \brief Secondary mode: infers the objects detected upstream and attaches their classification results
+///
+/// Objects are selected by class ID and minimum size, and objects attached by this element are skipped. The crop of
+/// each selected object is converted through the same path as full frames and submitted without waiting, so the crops
+/// of a batch are pipelined on the server. Tracked objects reuse their results until the re-inference interval has
+/// elapsed. Untracked objects cannot be matched with earlier results, so the results of their crops are awaited.
+///
+/// \param[in] dgaccelerator Pointer to the GstDgAccelerator instance
+/// \param[in] surface Pointer to the NvBufSurface of the batch
+/// \param[in] batch_meta Pointer to the NvDsBatchMeta of the batch
+/// \return Returns a GstFlowReturn value indicating the status of the function
+///
+static GstFlowReturn process_objects( GstDgAccelerator *dgaccelerator, NvBufSurface *surface, NvDsBatchMeta *batch_meta )
+{
+	/// \brief Selected object of the batch
+	struct SelectedObject
+	{
+		NvDsObjectMeta *object_meta;  //!< Metadata of the object
+		guint source_id;              //!< Source ID of the frame
+		guint64 key;                  //!< Tracker ID of the object, or index of the object in the frame if untracked
+		bool tracked;                 //!< Whether the object has a tracker ID
+	};
+	std::vector< SelectedObject > selected;
+	bool wait = false;
+	guint i = 0;  // frame number in the batch
+
+	for( NvDsMetaList *l_frame = batch_meta->frame_meta_list; l_frame != NULL; l_frame = l_frame->next, i++ )
+	{
+		NvDsFrameMeta *frame_meta = (NvDsFrameMeta *)( l_frame->data );
+		guint64 untracked = 0;
+		for( NvDsMetaList *l_obj = frame_meta->obj_meta_list; l_obj != NULL; l_obj = l_obj->next )
+		{
+			NvDsObjectMeta *object_meta = (NvDsObjectMeta *)( l_obj->data );
+			NvOSD_RectParams crop = object_meta->rect_params;
+			if( object_meta->unique_component_id == (gint)dgaccelerator->unique_id )
+				continue;
+			if( !dgaccelerator->class_ids->empty() && dgaccelerator->class_ids->count( object_meta->class_id ) == 0 )
+				continue;
+			if( crop.width < dgaccelerator->secondary_params.min_width || crop.height < dgaccelerator->secondary_params.min_height )
+				continue;
+
+			// Clip the object to the frame
+			crop.left = std::max( crop.left, 0.f );
+			crop.top = std::max( crop.top, 0.f );
+			crop.width = std::min( crop.width, dgaccelerator->video_info.width - crop.left );
+			crop.height = std::min( crop.height, dgaccelerator->video_info.height - crop.top );
+			if( crop.width < 2 || crop.height < 2 )
+				continue;
+
+			const bool tracked = object_meta->object_id != UNTRACKED_OBJECT_ID;
+			const guint64 key = tracked ? object_meta->object_id : untracked++;
+			if( DgAcceleratorObjectCheck( dgaccelerator->dgacceleratorlib_ctx, frame_meta->source_id, key, tracked ) )
+			{
+				if( get_converted_mat_2( dgaccelerator, surface, i, &crop, dgaccelerator->video_info.width, dgaccelerator->video_info.height ) !=
+					GST_FLOW_OK )
+					return GST_FLOW_ERROR;
+				DgAcceleratorProcessObject( dgaccelerator->dgacceleratorlib_ctx, dgaccelerator->cvmat->data, frame_meta->source_id, key, tracked );
+				wait |= !tracked;
+			}
+			selected.push_back( { object_meta, frame_meta->source_id, key, tracked } );
+		}
+	}
+
+	// Untracked objects have no earlier results, so the results of their crops are needed now
+	if( wait )
+		DgAcceleratorObjectsWait( dgaccelerator->dgacceleratorlib_ctx );
+
+	DgAcceleratorClassObject classes[ MAX_OBJ_PER_FRAME ];
+	for( const SelectedObject &object : selected )
+	{
+		const gint count =
+			DgAcceleratorObjectResults( dgaccelerator->dgacceleratorlib_ctx, object.source_id, object.key, object.tracked, classes, MAX_OBJ_PER_FRAME );
+		if( count > 0 )
+			attach_classifier_metadata( dgaccelerator, dgaccelerator->dgacceleratorlib_ctx, batch_meta, object.object_meta, classes, count );
+	}
+
+	for( NvDsMetaList *l_frame = batch_meta->frame_meta_list; l_frame != NULL; l_frame = l_frame->next )
+		DgAcceleratorObjectsFrameEnd( dgaccelerator->dgacceleratorlib_ctx, ( (NvDsFrameMeta *)( l_frame->data ) )->source_id );
+
+	return GST_FLOW_OK;
+}
+
+///
+/// \brief Secondary mode: attaches classification results to an object as NvDsClassifierMeta
+///
+/// Every result becomes a NvDsLabelInfo of one classifier meta. When drawing, the top result is also appended to the
+/// display text of the object.
+///
+/// \param[in] dgaccelerator Pointer to the GstDgAccelerator instance
+/// \param[in] ctx Context of the model which produced the results, resolving their labels
+/// \param[in] batch_meta Pointer to the NvDsBatchMeta of the batch
+/// \param[in] object_meta Pointer to the NvDsObjectMeta of the parent object
+/// \param[in] classes Classification results of the object
+/// \param[in] count Number of classification results
+///
+static void attach_classifier_metadata(
+	GstDgAccelerator *dgaccelerator,
+	DgAcceleratorCtx *ctx,
+	NvDsBatchMeta *batch_meta,
+	NvDsObjectMeta *object_meta,
+	const DgAcceleratorClassObject *classes,
+	gint count )
+{
+	NvDsClassifierMeta *classifier_meta = nvds_acquire_classifier_meta_from_pool( batch_meta );
+	classifier_meta->unique_component_id = dgaccelerator->unique_id;
+	classifier_meta->num_labels = count;
+	for( gint i = 0; i < count; i++ )
+	{
+		NvDsLabelInfo *label_info = nvds_acquire_label_info_meta_from_pool( batch_meta );
+		label_info->label_id = i;
+		label_info->result_class_id = classes[ i ].classId;
+		label_info->result_prob = classes[ i ].score;
+		g_strlcpy( label_info->result_label, DgAcceleratorLabel( ctx, classes[ i ].labelId ), MAX_LABEL_SIZE );
+		nvds_add_label_info_meta_to_classifier( classifier_meta, label_info );
+	}
+	nvds_add_classifier_meta_to_object( object_meta, classifier_meta );
+	if( !dgaccelerator->draw )
+		return;
+
+	// Show the top result next to the existing text of the object
+	const char *label = DgAcceleratorLabel( ctx, classes[ 0 ].labelId );
+	gchar *display_text = object_meta->text_params.display_text;
+	object_meta->text_params.display_text = display_text ? g_strdup_printf( "%s %s", display_text, label ) : g_strdup( label );
+	g_free( display_text );
+}
+
 ///
 /// \brief Attaches metadata for the processed video frame using NvDsBatch Meta
 ///
@@ -1071,17 +2275,25 @@ error:
 /// processed video frame.
 ///
 /// \param[in] dgaccelerator Pointer to the GstDgAccelerator instance
+/// \param[in] ctx Context of the model which produced the output
+/// \param[in] model_width Processing width of the model which produced the output
+/// \param[in] model_height Processing height of the model which produced the output
 /// \param[in] frame_meta Pointer to the NvDsFrameMeta instance for the video frame
 /// \param[in] scale_ratio The scale ratio used for processing the frame
 /// \param[in] output Pointer to the DgAcceleratorOutput instance for the output
 /// \param[in] batch_id The frame number in the batch, unused
+/// \param[in] roi Region of the batched frame which was scaled to processing resolution
 ///
 static void attach_metadata_full_frame(
 	GstDgAccelerator *dgaccelerator,
+	DgAcceleratorCtx *ctx,
+	gint model_width,
+	gint model_height,
 	NvDsFrameMeta *frame_meta,
 	gdouble scale_ratio,
 	DgAcceleratorOutput *output,
-	guint batch_id )
+	guint batch_id,
+	const NvOSD_RectParams *roi )
 {
 	NvDsBatchMeta *batch_meta = frame_meta->base_meta.batch_meta;
 	NvDsObjectMeta *object_meta = NULL;
@@ -1090,25 +2302,48 @@ static void attach_metadata_full_frame(
 	int frame_width = frame_meta->source_frame_width;
 	int frame_height = frame_meta->source_frame_height;
 
-	// Calculate the scale factors for width and height
-	gdouble scale_ratio_width = frame_width / (gdouble)dgaccelerator->processing_width;
-	gdouble scale_ratio_height = frame_height / (gdouble)dgaccelerator->processing_height;
+	// Calculate the scale factors for width and height, mapping the region of interest back into the frame
+	gdouble frame_ratio_width = frame_width / (gdouble)dgaccelerator->video_info.width;
+	gdouble frame_ratio_height = frame_height / (gdouble)dgaccelerator->video_info.height;
+	gdouble scale_ratio_width = roi->width * frame_ratio_width / model_width;
+	gdouble scale_ratio_height = roi->height * frame_ratio_height / model_height;
+	gdouble offset_x = roi->left * frame_ratio_width;
+	gdouble offset_y = roi->top * frame_ratio_height;
+
+	// With the built-in tracker, tracked objects replace the detections of the frame
+	DgAcceleratorTrackedObject tracks[ MAX_OBJ_PER_FRAME ];
+	gint numTracks = -1;
+	if( dgaccelerator->tracker_params.enable )
+		numTracks = DgAcceleratorTrackObjects( ctx, frame_meta->source_id, output, tracks, MAX_OBJ_PER_FRAME );
+	const gint numObjects = numTracks >= 0 ? numTracks : output->numObjects;
 
 	// Object Detection loop in DgAcceleratorOutput
-	for( gint i = 0; i < output->numObjects; i++ )
+	for( gint i = 0; i < numObjects; i++ )
 	{
-		DgAcceleratorObject *obj = &output->object[ i ];
+		DgAcceleratorObject *obj = numTracks >= 0 ? &tracks[ i ].object : &output->object[ i ];
 		object_meta = nvds_acquire_obj_meta_from_pool( batch_meta );
 		NvOSD_RectParams &rect_params = object_meta->rect_params;
 		NvOSD_TextParams &text_params = object_meta->text_params;
 
 		// Assign bounding box coordinates and
 		// Scale the bounding boxes
-		rect_params.left = obj->left * scale_ratio_width;
-		rect_params.top = obj->top * scale_ratio_height;
+		rect_params.left = offset_x + obj->left * scale_ratio_width;
+		rect_params.top = offset_y + obj->top * scale_ratio_height;
 		rect_params.width = obj->width * scale_ratio_width;
 		rect_params.height = obj->height * scale_ratio_height;
 
+		object_meta->object_id = numTracks >= 0 ? tracks[ i ].id : UNTRACKED_OBJECT_ID;
+		object_meta->unique_component_id = dgaccelerator->unique_id;
+		object_meta->class_id = obj->classId;
+		object_meta->confidence = obj->score;
+		const char *label = DgAcceleratorLabel( ctx, obj->labelId );
+		g_strlcpy( object_meta->obj_label, label, MAX_LABEL_SIZE );
+		if( !dgaccelerator->draw )
+		{
+			nvds_add_obj_meta_to_frame( frame_meta, object_meta, NULL );
+			continue;
+		}
+
 		// Background color for rectangle, default off
 		rect_params.has_bg_color = 0;
 		rect_params.bg_color = ( NvOSD_ColorParams ){ 1, 1, 0, 0.4 };
@@ -1117,10 +2352,8 @@ static void attach_metadata_full_frame(
 		// Set box color
 		rect_params.border_color = dgaccelerator->color;
 
-		object_meta->object_id = UNTRACKED_OBJECT_ID;
-		g_strlcpy( object_meta->obj_label, obj->label, MAX_LABEL_SIZE );
 		// display_text requires heap allocated memory
-		text_params.display_text = g_strdup( obj->label );
+		text_params.display_text = g_strdup( label );
 		// Display text above the left top corner of the object
 		text_params.x_offset = rect_params.left;
 		text_params.y_offset = rect_params.top - 10;
@@ -1135,72 +2368,111 @@ static void attach_metadata_full_frame(
 		nvds_add_obj_meta_to_frame( frame_meta, object_meta, NULL );
 	}
 	// Pose Estimation in DgAcceleratorOutput
+	const DgAcceleratorPoses &poses = output->poses;
+	const DgAcceleratorSkeleton *skeleton = output->numPoses > 0 ? DgAcceleratorPoseSkeleton( ctx ) : NULL;
+	NvDsDisplayMeta *dmeta = NULL;
+	GstDgAcceleratorPoseKeypoint keypoints[ MAX_KEYPOINTS_PER_FRAME ];
 	for( gint j = 0; j < output->numPoses; j++ )
 	{
-		DgAcceleratorPose *pose = &output->pose[ j ];
-		NvDsDisplayMeta *dmeta = nvds_acquire_display_meta_from_pool( batch_meta );
-		nvds_add_display_meta_to_frame( frame_meta, dmeta );
+		const int first = poses.first[ j ];
+		const int count = poses.first[ j + 1 ] - first;
+		if( count == 0 )
+			continue;
+
+		// Scale the keypoints back, and bound them
+		GstDgAcceleratorPoseKeypoint *pose = keypoints + first;
+		float left = G_MAXFLOAT, top = G_MAXFLOAT, right = -G_MAXFLOAT, bottom = -G_MAXFLOAT;
+		for( int k = 0; k < count; k++ )
+		{
+			pose[ k ].x = offset_x + poses.x[ first + k ] * scale_ratio_width;
+			pose[ k ].y = offset_y + poses.y[ first + k ] * scale_ratio_height;
+			pose[ k ].score = poses.keypointScore[ first + k ];
+			pose[ k ].class_id = poses.classId[ first + k ];
+			left = std::min( left, pose[ k ].x );
+			right = std::max( right, pose[ k ].x );
+			top = std::min( top, pose[ k ].y );
+			bottom = std::max( bottom, pose[ k ].y );
+		}
+
+		// Every pose is an object without a label, carrying its keypoints as user meta
+		object_meta = nvds_acquire_obj_meta_from_pool( batch_meta );
+		object_meta->rect_params.left = left;
+		object_meta->rect_params.top = top;
+		object_meta->rect_params.width = right - left;
+		object_meta->rect_params.height = bottom - top;
+		object_meta->object_id = UNTRACKED_OBJECT_ID;
+		object_meta->unique_component_id = dgaccelerator->unique_id;
+		object_meta->confidence = poses.score[ j ];
+		nvds_add_obj_meta_to_frame( frame_meta, object_meta, NULL );
+		attachPoseMetadata( object_meta, dgaccelerator->frame_num, pose, count );
+		if( !dgaccelerator->draw )
+			continue;
 
-		for( const auto &landmark : pose->landmarks )
+		// Add circle at each keypoint
+		for( int k = 0; k < count; k++ )
 		{
-			int x = static_cast< int >( landmark.point.first );
-			int y = static_cast< int >( landmark.point.second );
-			// scale back
-			x = static_cast< int >( landmark.point.first * scale_ratio_width );
-			y = static_cast< int >( landmark.point.second * scale_ratio_height );
-			if( dmeta->num_circles == MAX_ELEMENTS_IN_DISPLAY_META )
+			if( !dmeta || dmeta->num_circles == MAX_ELEMENTS_IN_DISPLAY_META )
 			{
 				dmeta = nvds_acquire_display_meta_from_pool( batch_meta );
 				nvds_add_display_meta_to_frame( frame_meta, dmeta );
 			}
-			// Add circle at each landmark
 			NvOSD_CircleParams &cparams = dmeta->circle_params[ dmeta->num_circles ];
-			cparams.xc = x;
-			cparams.yc = y;
+			cparams.xc = static_cast< int >( pose[ k ].x );
+			cparams.yc = static_cast< int >( pose[ k ].y );
 			cparams.radius = 8;
 			cparams.circle_color = NvOSD_ColorParams{ 0, 255, 0, 1 };
 			cparams.has_bg_color = 1;
 			cparams.bg_color = NvOSD_ColorParams{ 200, 0, 40, 1 };
 			dmeta->num_circles++;
+		}
 
-			// Add lines
-			for( int connection_index : landmark.connection )
+		// Add a line for each connection of the skeleton, drawn once even though both keypoints list it
+		if( skeleton == NULL )
+			continue;
+		for( const auto &[ a, b ] : skeleton->edges )
+		{
+			if( b >= count )
+				continue;
+			if( dmeta->num_lines == MAX_ELEMENTS_IN_DISPLAY_META )
 			{
-				if( connection_index >= 0 && connection_index < pose->landmarks.size() )
-				{
-					auto &connected_landmark = pose->landmarks[ connection_index ];
-					int x1 = static_cast< int >( connected_landmark.point.first );
-					int y1 = static_cast< int >( connected_landmark.point.second );
-					// scale back
-					x1 = static_cast< int >( connected_landmark.point.first * scale_ratio_width );
-					y1 = static_cast< int >( connected_landmark.point.second * scale_ratio_height );
-					if( dmeta->num_lines == MAX_ELEMENTS_IN_DISPLAY_META )
-					{
-						dmeta = nvds_acquire_display_meta_from_pool( batch_meta );
-						nvds_add_display_meta_to_frame( frame_meta, dmeta );
-					}
-					NvOSD_LineParams &lparams = dmeta->line_params[ dmeta->num_lines ];
-					lparams.x1 = x;
-					lparams.x2 = x1;
-					lparams.y1 = y;
-					lparams.y2 = y1;
-					lparams.line_width = 3;
-					lparams.line_color = NvOSD_ColorParams{ 255, 0, 0, 1 };
-					dmeta->num_lines++;
-				}
+				dmeta = nvds_acquire_display_meta_from_pool( batch_meta );
+				nvds_add_display_meta_to_frame( frame_meta, dmeta );
 			}
+			NvOSD_LineParams &lparams = dmeta->line_params[ dmeta->num_lines ];
+			lparams.x1 = static_cast< int >( pose[ a ].x );
+			lparams.y1 = static_cast< int >( pose[ a ].y );
+			lparams.x2 = static_cast< int >( pose[ b ].x );
+			lparams.y2 = static_cast< int >( pose[ b ].y );
+			lparams.line_width = 3;
+			lparams.line_color = NvOSD_ColorParams{ 255, 0, 0, 1 };
+			dmeta->num_lines++;
 		}
-		// nvds_add_display_meta_to_frame(frame_meta, dmeta);
+	}
+	// Without decoration, the classification results become one object covering the region of interest
+	if( !dgaccelerator->draw && output->k > 0 )
+	{
+		object_meta = nvds_acquire_obj_meta_from_pool( batch_meta );
+		object_meta->rect_params.left = offset_x;
+		object_meta->rect_params.top = offset_y;
+		object_meta->rect_params.width = roi->width * frame_ratio_width;
+		object_meta->rect_params.height = roi->height * frame_ratio_height;
+		object_meta->object_id = UNTRACKED_OBJECT_ID;
+		object_meta->unique_component_id = dgaccelerator->unique_id;
+		object_meta->class_id = output->classifiedObject[ 0 ].classId;
+		object_meta->confidence = output->classifiedObject[ 0 ].score;
+		g_strlcpy( object_meta->obj_label, DgAcceleratorLabel( ctx, output->classifiedObject[ 0 ].labelId ), MAX_LABEL_SIZE );
+		nvds_add_obj_meta_to_frame( frame_meta, object_meta, NULL );
+		attach_classifier_metadata( dgaccelerator, ctx, batch_meta, object_meta, output->classifiedObject, output->k );
 	}
 	// Classification loop in DgAcceleratorOutput
-	for( int i = 0; i < output->k; i++ )
+	for( int i = 0; dgaccelerator->draw && i < output->k; i++ )
 	{
 		DgAcceleratorClassObject *class_obj = &output->classifiedObject[ i ];
 		object_meta = nvds_acquire_obj_meta_from_pool( batch_meta );
 		NvOSD_TextParams &text_params = object_meta->text_params;
 
 		// Display the label and score as text above the frame
-		text_params.display_text = g_strdup_printf( "%s: %.2f", class_obj->label, class_obj->score );
+		text_params.display_text = g_strdup_printf( "%s: %.2f", DgAcceleratorLabel( ctx, class_obj->labelId ), class_obj->score );
 		text_params.x_offset = 10;
 		text_params.y_offset = 30 + i * 20;  // Adjust the y-offset for each label
 		text_params.font_params.font_name = font_name;
@@ -1215,67 +2487,532 @@ static void attach_metadata_full_frame(
 	}
 
 	// Segmentation loop in DgAcceleratorOutput
-	if( !output->segMap.class_map.empty() )
-	{
-		// Resize the segmentation map to original frame dimensions
-		// Convert class_map to cv::Mat
-		cv::Mat classMapMat( output->segMap.mask_height, output->segMap.mask_width, CV_32S, output->segMap.class_map.data() );
-		// Create a new cv::Mat for the resized map
-		cv::Mat resizedClassMapMat;
-		// Resize the class map
-		cv::resize( classMapMat, resizedClassMapMat, cv::Size( frame_width, frame_height ), 0, 0, cv::INTER_NEAREST );
-		// attach the segmentation metadata to the frame
-		attachSegmentationMetadata( frame_meta, dgaccelerator->frame_num, frame_width, frame_height, (const int *)resizedClassMapMat.data );
+	if( output->segMap.class_map )
+	{
+		// Placement of the class map on the frame
+		GstDgAcceleratorSegmentationMeta placement;
+		placement.frame_num = dgaccelerator->frame_num;
+		placement.width = output->segMap.mask_width;
+		placement.height = output->segMap.mask_height;
+		placement.offset_x = offset_x;
+		placement.offset_y = offset_y;
+		placement.scale_x = roi->width * frame_ratio_width / output->segMap.mask_width;
+		placement.scale_y = roi->height * frame_ratio_height / output->segMap.mask_height;
+		placement.class_map = nullptr;
+		placement.priv_data = nullptr;
+
+		if( dgaccelerator->segmentation_stats )
+		{
+			// Statistics of the classes in one pass over the model resolution map
+			std::vector< DgAcceleratorClassStats > stats;
+			DgAcceleratorMaskStats( segmentationClassMap( output->segMap, 1 ).get(), placement.width, placement.height, stats );
+			attachSegmentationStatsMetadata( frame_meta, stats, placement );
+		}
+
+		switch( dgaccelerator->segmentation_output )
+		{
+		case DGACCELERATOR_SEGMENTATION_OUTPUT_FRAME:
+		{
+			// Upscale the segmentation map to original frame dimensions, into a pooled buffer handed over to the metadata
+			DgAcceleratorMaskBuffer classMap = segmentationClassMap( output->segMap, 1 );
+			DgAcceleratorMaskBuffer resizedClassMap = DgAcceleratorMaskAcquire( frame_width * frame_height * sizeof( int ) );
+			int32_t *resized = (int32_t *)resizedClassMap.get();
+			cv::Rect roiRect( (int)std::round( offset_x ), (int)std::round( offset_y ), (int)std::round( roi->width * frame_ratio_width ),
+				(int)std::round( roi->height * frame_ratio_height ) );
+			roiRect = roiRect & cv::Rect( 0, 0, frame_width, frame_height );
+			// Pixels outside of the region of interest are left as class 0
+			if( roiRect.area() != frame_width * frame_height )
+				std::fill( resized, resized + frame_width * frame_height, 0 );
+			// Upscale the class map into the region of interest, with the index tables of the model and source
+			DgAcceleratorSourceMaskUpscaler( ctx, frame_meta->source_id ).upscale( classMap.get(), output->segMap.mask_width,
+				output->segMap.mask_height, resized + roiRect.y * frame_width + roiRect.x, frame_width, roiRect.width, roiRect.height );
+			placement.width = frame_width;
+			placement.height = frame_height;
+			placement.offset_x = placement.offset_y = 0;
+			placement.scale_x = placement.scale_y = 1;
+			attachSegmentationMetadata( frame_meta, dgaccelerator->frame_num, resizedClassMap, placement );
+			break;
+		}
+		case DGACCELERATOR_SEGMENTATION_OUTPUT_MODEL:
+			// Attach the map at model resolution, leaving the expansion to frame resolution to the consumers which need it
+			attachSegmentationMetadata( frame_meta, dgaccelerator->frame_num, segmentationClassMap( output->segMap, sizeof( int ) ), placement );
+			break;
+		case DGACCELERATOR_SEGMENTATION_OUTPUT_MODEL_UINT8:
+			attachSegmentationUint8Metadata( frame_meta, segmentationClassMap( output->segMap, 1 ), placement );
+			break;
+		case DGACCELERATOR_SEGMENTATION_OUTPUT_POLYGONS:
+		{
+			// Outline the regions of the model resolution map, then draw the polygons in frame coordinates
+			std::vector< DgAcceleratorPolygon > polygons;
+			DgAcceleratorMaskPolygons( segmentationClassMap( output->segMap, 1 ).get(), placement.width, placement.height,
+				dgaccelerator->polygon_tolerance, polygons );
+			const GstDgAcceleratorSegmentationPolygonsMeta *polygons_meta = attachSegmentationPolygonsMetadata( frame_meta, polygons, placement );
+
+			NvDsDisplayMeta *dmeta = NULL;
+			for( guint p = 0; dgaccelerator->draw && p < polygons_meta->num_polygons; p++ )
+			{
+				const GstDgAcceleratorSegmentationPolygon &polygon = polygons_meta->polygons[ p ];
+				for( guint v = 0; v < polygon.num_points; v++ )
+				{
+					if( !dmeta || dmeta->num_lines == MAX_ELEMENTS_IN_DISPLAY_META )
+					{
+						dmeta = nvds_acquire_display_meta_from_pool( batch_meta );
+						nvds_add_display_meta_to_frame( frame_meta, dmeta );
+					}
+					const guint next = ( v + 1 ) % polygon.num_points;
+					NvOSD_LineParams &lparams = dmeta->line_params[ dmeta->num_lines ];
+					lparams.x1 = polygon.points[ 2 * v ];
+					lparams.y1 = polygon.points[ 2 * v + 1 ];
+					lparams.x2 = polygon.points[ 2 * next ];
+					lparams.y2 = polygon.points[ 2 * next + 1 ];
+					lparams.line_width = 2;
+					lparams.line_color = dgaccelerator->color;
+					dmeta->num_lines++;
+				}
+			}
+			break;
+		}
+		case DGACCELERATOR_SEGMENTATION_OUTPUT_NONE:
+			break;
+		}
 	}
 	frame_meta->bInferDone = TRUE;
 }
 
 ///
-/// \brief Releases the memory associated with the given segmentation metadata.
+/// \brief Parses the roi property into regions of interest by source ID
 ///
-/// This function releases the memory associated with the given segmentation metadata. It first checks if the metadata
-/// is valid and if the class_map and class_probabilities_map pointers are not null. If they are not null, it frees the
-/// memory associated with them. Finally, it deletes the metadata object and sets the user_meta_data
-/// pointer to null.
+/// The property holds source_id:left,top,width,height entries separated by ';', with coordinates in pixels of the
+/// batched frames. An empty string yields no regions of interest, so every source is inferred on full frames.
 ///
-/// \param[in] data A gpointer to the user meta data to be released.
-/// \param[in] user_data Unused, but required
+/// \param[in] roi The roi property string
+/// \param[out] roi_map Regions of interest by source ID
+/// \return Returns TRUE if the string is valid, FALSE otherwise
 ///
-static void releaseSegmentationMeta( gpointer data, gpointer user_data )
+static gboolean parse_roi( const char *roi, std::map< guint, NvOSD_RectParams > &roi_map )
 {
-	if( data == nullptr )
-		return;
-
-	NvDsUserMeta *user_meta = (NvDsUserMeta *)data;
+	std::istringstream entries( roi );
+	std::string entry;
+	while( std::getline( entries, entry, ';' ) )
+	{
+		if( entry.find_first_not_of( " \t" ) == std::string::npos )
+			continue;
+		guint source_id;
+		int left, top, width, height;
+		char end;
+		if( sscanf( entry.c_str(), " %u : %d , %d , %d , %d %c", &source_id, &left, &top, &width, &height, &end ) != 5 )
+			return FALSE;
+		if( left < 0 || top < 0 || width < 2 || height < 2 )
+			return FALSE;
+		NvOSD_RectParams &rect = roi_map[ source_id ];
+		rect.left = left;
+		rect.top = top;
+		rect.width = width;
+		rect.height = height;
+	}
+	return TRUE;
+}
+
+///
+/// \brief Parses the operate-on-class-ids or class-filter property into a set of class IDs
+///
+/// \param[in] class_ids The property string, class IDs separated by ';'
+/// \param[out] class_id_set Set of class IDs, left empty when all classes are selected
+/// \return Returns TRUE if the string is valid, FALSE otherwise
+///
+static gboolean parse_class_ids( const char *class_ids, std::set< gint > &class_id_set )
+{
+	std::istringstream entries( class_ids );
+	std::string entry;
+	while( std::getline( entries, entry, ';' ) )
+	{
+		if( entry.find_first_not_of( " \t" ) == std::string::npos )
+			continue;
+		gint class_id;
+		char end;
+		if( sscanf( entry.c_str(), " %d %c", &class_id, &end ) != 1 )
+			return FALSE;
+		class_id_set.insert( class_id );
+	}
+	return TRUE;
+}
+
+///
+/// \brief Parses the extra-models property into additional models
+///
+/// The property holds model_name[:width,height[,conf_threshold]] entries separated by ';'. Models without a resolution
+/// use the processing resolution, and models without a confidence threshold use the output-conf-threshold property.
+///
+/// \param[in] extra_models The extra-models property string
+/// \param[in] width Processing width, used by models without a resolution
+/// \param[in] height Processing height, used by models without a resolution
+/// \param[out] model_list Additional models, with their contexts not initialized yet
+/// \return Returns TRUE if the string is valid, FALSE otherwise
+///
+static gboolean parse_extra_models( const char *extra_models, gint width, gint height, std::vector< GstDgAcceleratorModel > &model_list )
+{
+	std::istringstream entries( extra_models );
+	std::string entry;
+	while( std::getline( entries, entry, ';' ) )
+	{
+		const size_t begin = entry.find_first_not_of( " \t" );
+		if( begin == std::string::npos )
+			continue;
+		GstDgAcceleratorModel model = { "", width, height, -1, -1, NULL, NULL };
+		const size_t colon = entry.find( ':' );
+		model.name = entry.substr( begin, colon == std::string::npos ? std::string::npos : colon - begin );
+		model.name.erase( model.name.find_last_not_of( " \t" ) + 1 );
+		if( model.name.empty() )
+			return FALSE;
+		if( colon != std::string::npos )
+		{
+			char end;
+			const int fields = sscanf( entry.c_str() + colon + 1, " %d , %d , %lf %c", &model.width, &model.height, &model.conf_threshold, &end );
+			if( fields != 2 && fields != 3 )
+				return FALSE;
+			if( fields == 2 && sscanf( entry.c_str() + colon + 1, " %*d , %*d %c", &end ) == 1 )
+				return FALSE;
+			if( model.width <= 0 || model.height <= 0 || ( fields == 3 && ( model.conf_threshold < 0 || model.conf_threshold > 1 ) ) )
+				return FALSE;
+		}
+		model_list.push_back( model );
+	}
+	return TRUE;
+}
+
+///
+/// \brief Deinitializes the additional models and frees their resized frames
+/// \param[in] dgaccelerator Pointer to the GstDgAccelerator instance
+///
+static void free_extra_models( GstDgAccelerator *dgaccelerator )
+{
+	if( !dgaccelerator->model_list )
+		return;
+	for( GstDgAcceleratorModel &model : *dgaccelerator->model_list )
+	{
+		if( model.ctx )
+			DgAcceleratorCtxDeinit( model.ctx );
+		delete model.cvmat;
+	}
+	delete dgaccelerator->model_list;
+	dgaccelerator->model_list = NULL;
+}
+
+///
+/// \brief Initializes the contexts of the model and of the additional models, then warms them up
+///
+/// Called from start, or from init_thread with async-start.
+///
+/// \param[in] dgaccelerator Pointer to the GstDgAccelerator instance
+///
+static void init_models( GstDgAccelerator *dgaccelerator )
+{
+	// Initialize our context with the parameters
+	dgaccelerator->dgacceleratorlib_ctx = DgAcceleratorCtxInit( dgaccelerator );
+
+	// Initialize the additional models. Models share the frame converted at processing resolution, or the frame resized
+	// for the first model of the same resolution.
+	for( size_t m = 0; m < dgaccelerator->model_list->size(); m++ )
+	{
+		GstDgAcceleratorModel &model = ( *dgaccelerator->model_list )[ m ];
+		model.ctx = DgAcceleratorCtxInit( dgaccelerator, { model.name, model.width, model.height, model.conf_threshold } );
+		model.frame = -1;
+		if( model.width == dgaccelerator->processing_width && model.height == dgaccelerator->processing_height )
+			continue;
+		model.frame = m;
+		for( size_t n = 0; n < m; n++ )
+		{
+			const GstDgAcceleratorModel &other = ( *dgaccelerator->model_list )[ n ];
+			if( other.frame == (gint)n && other.width == model.width && other.height == model.height )
+			{
+				model.frame = n;
+				break;
+			}
+		}
+		if( model.frame == (gint)m )
+			model.cvmat = new cv::Mat( model.height, model.width, CV_8UC3 );
+	}
+
+	// Pay for the connection and model load before the first buffer
+	if( dgaccelerator->warm_up_frames > 0 )
+	{
+		DgAcceleratorWarmUp( dgaccelerator->dgacceleratorlib_ctx, dgaccelerator->warm_up_frames );
+		for( GstDgAcceleratorModel &model : *dgaccelerator->model_list )
+			DgAcceleratorWarmUp( model.ctx, dgaccelerator->warm_up_frames );
+	}
+}
+
+///
+/// \brief Waits for the models initialized in the background with async-start
+/// \param[in] dgaccelerator Pointer to the GstDgAccelerator instance
+/// \return Returns FALSE if the initialization failed
+///
+static gboolean init_wait( GstDgAccelerator *dgaccelerator )
+{
+	if( dgaccelerator->init_thread )
+	{
+		dgaccelerator->init_thread->join();
+		delete dgaccelerator->init_thread;
+		dgaccelerator->init_thread = NULL;
+		// Tile layouts depend on the frame size, which may have been negotiated meanwhile
+		if( dgaccelerator->init_error->empty() && dgaccelerator->tiling_params.enable &&
+			dgaccelerator->process_mode == DGACCELERATOR_PROCESS_MODE_PRIMARY && dgaccelerator->video_info.width > 0 )
+			DgAcceleratorTilingSet( dgaccelerator->dgacceleratorlib_ctx, dgaccelerator->video_info.width, dgaccelerator->video_info.height );
+	}
+	if( dgaccelerator->init_error && !dgaccelerator->init_error->empty() )
+	{
+		GST_ELEMENT_ERROR( dgaccelerator, LIBRARY, INIT, ( "Could not initialize the model." ), ( "%s", dgaccelerator->init_error->c_str() ) );
+		return FALSE;
+	}
+	return TRUE;
+}
+
+///
+/// \brief Sets model-name or server_ip
+///
+/// Before start and after stop, the value is set directly. In between, the models being initialized or swapped read
+/// the current value, so the new one is kept pending for the streaming thread to swap in on its next buffer, without
+/// waiting for the model in progress.
+///
+/// \param[in] dgaccelerator Pointer to the GstDgAccelerator instance
+/// \param[in,out] current The current value
+/// \param[in,out] pending The pending value, NULL if none
+/// \param[in] value The new value
+///
+static void model_string_set( GstDgAccelerator *dgaccelerator, char *&current, char *&pending, const char *value )
+{
+	char *copy = new char[ strlen( value ) + 1 ];
+	strcpy( copy, value );
+	std::lock_guard< std::mutex > lock( *dgaccelerator->swap_mutex );
+	if( dgaccelerator->models_started )
+	{
+		delete[] pending;
+		pending = copy;
+	}
+	else
+		current = copy;
+}
+
+///
+/// \brief Waits for the model swap in progress, if any
+/// \param[in] dgaccelerator Pointer to the GstDgAccelerator instance
+///
+static void model_swap_join( GstDgAccelerator *dgaccelerator )
+{
+	if( !dgaccelerator->swap_thread )
+		return;
+	dgaccelerator->swap_thread->join();
+	delete dgaccelerator->swap_thread;
+	dgaccelerator->swap_thread = NULL;
+}
+
+///
+/// \brief Deinitializes the contexts of a model swap and frees it
+/// \param[in] swap The contexts of the swap
+///
+static void model_swap_free( GstDgAcceleratorSwap *swap )
+{
+	if( swap->ctx )
+		DgAcceleratorCtxDeinit( swap->ctx );
+	for( DgAcceleratorCtx *ctx : swap->models )
+		DgAcceleratorCtxDeinit( ctx );
+	delete swap;
+}
+
+///
+/// \brief Starts swapping the model after model-name or server_ip changed in PLAYING state
+///
+/// The new model, and a new instance of each additional model so that they follow a change of server_ip, are connected
+/// and warmed up on a background thread while the current models keep inferring frames. The new contexts are then
+/// handed over to the streaming thread, which switches to all of them on its next buffer. If any model fails to
+/// initialize, a warning is posted and the current models are kept.
+///
+/// \param[in] dgaccelerator Pointer to the GstDgAccelerator instance
+///
+static void model_swap_start( GstDgAccelerator *dgaccelerator )
+{
+	dgaccelerator->swap_building->store( true );
+	dgaccelerator->swap_thread = new std::thread( [ dgaccelerator ]() {
+		GstDgAcceleratorSwap *swap = new GstDgAcceleratorSwap{ NULL, {} };
+		try
+		{
+			swap->ctx = DgAcceleratorCtxInit( dgaccelerator );
+			for( const GstDgAcceleratorModel &model : *dgaccelerator->model_list )
+				swap->models.push_back( DgAcceleratorCtxInit( dgaccelerator, { model.name, model.width, model.height, model.conf_threshold } ) );
+			DgAcceleratorWarmUp( swap->ctx, SWAP_WARMUP_FRAMES );
+			for( DgAcceleratorCtx *ctx : swap->models )
+				DgAcceleratorWarmUp( ctx, SWAP_WARMUP_FRAMES );
+		}
+		catch( const std::exception &e )
+		{
+			model_swap_free( swap );
+			GST_ELEMENT_WARNING(
+				dgaccelerator, LIBRARY, SETTINGS, ( "Could not switch to model '%s', keeping the current model.", dgaccelerator->model_name ),
+				( "%s", e.what() ) );
+			dgaccelerator->swap_building->store( false );
+			return;
+		}
+		// Contexts built earlier and not switched to yet are replaced
+		GstDgAcceleratorSwap *stale = dgaccelerator->swap_ctx->exchange( swap );
+		if( stale )
+			model_swap_free( stale );
+		dgaccelerator->swap_building->store( false );
+	} );
+}
+
+///
+/// \brief Starts swapping the model if model-name or server_ip changed since start, called from the streaming thread
+///
+/// The pending values are taken over only once the swap in progress, which reads the current ones, has finished
+/// building, so a change made meanwhile is swapped in by a later buffer rather than lost.
+///
+/// \param[in] dgaccelerator Pointer to the GstDgAccelerator instance
+///
+static void model_swap_request( GstDgAccelerator *dgaccelerator )
+{
+	if( dgaccelerator->swap_thread )
+	{
+		if( dgaccelerator->swap_building->load() )
+			return;
+		model_swap_join( dgaccelerator );
+	}
+	{
+		std::lock_guard< std::mutex > lock( *dgaccelerator->swap_mutex );
+		if( !dgaccelerator->swap_model_name && !dgaccelerator->swap_server_ip )
+			return;
+		if( dgaccelerator->swap_model_name )
+			dgaccelerator->model_name = dgaccelerator->swap_model_name;
+		if( dgaccelerator->swap_server_ip )
+			dgaccelerator->server_ip = dgaccelerator->swap_server_ip;
+		dgaccelerator->swap_model_name = dgaccelerator->swap_server_ip = NULL;
+	}
+	model_swap_start( dgaccelerator );
+}
+
+///
+/// \brief Switches to the swapped models if they are ready, called from the streaming thread
+///
+/// The replaced contexts drain their in-flight frames and are deinitialized on a background thread, so the stream does
+/// not stall. Results of the frames in flight on the replaced models are not attached.
+///
+/// \param[in] dgaccelerator Pointer to the GstDgAccelerator instance
+///
+static void model_swap_apply( GstDgAccelerator *dgaccelerator )
+{
+	GstDgAcceleratorSwap *swap = dgaccelerator->swap_ctx->exchange( nullptr );
+	if( !swap )
+		return;
+	if( dgaccelerator->tiling_params.enable && dgaccelerator->process_mode == DGACCELERATOR_PROCESS_MODE_PRIMARY )
+		DgAcceleratorTilingSet( swap->ctx, dgaccelerator->video_info.width, dgaccelerator->video_info.height );
+	// Exchange the contexts, so that swap holds the replaced ones
+	std::swap( dgaccelerator->dgacceleratorlib_ctx, swap->ctx );
+	for( size_t m = 0; m < swap->models.size(); m++ )
+		std::swap( ( *dgaccelerator->model_list )[ m ].ctx, swap->models[ m ] );
+	if( dgaccelerator->retire_thread )
+	{
+		dgaccelerator->retire_thread->join();
+		delete dgaccelerator->retire_thread;
+	}
+	dgaccelerator->retire_thread = new std::thread( model_swap_free, swap );
+	GST_ELEMENT_INFO( dgaccelerator, LIBRARY, SETTINGS, ( "Switched to model '%s'.", dgaccelerator->model_name ), ( NULL ) );
+}
+
+///
+/// \brief Waits for the model swap threads and frees the context built but not switched to
+/// \param[in] dgaccelerator Pointer to the GstDgAccelerator instance
+///
+static void model_swap_stop( GstDgAccelerator *dgaccelerator )
+{
+	model_swap_join( dgaccelerator );
+	if( dgaccelerator->swap_ctx )
+	{
+		GstDgAcceleratorSwap *swap = dgaccelerator->swap_ctx->exchange( nullptr );
+		if( swap )
+			model_swap_free( swap );
+		delete dgaccelerator->swap_ctx;
+		dgaccelerator->swap_ctx = NULL;
+	}
+	delete dgaccelerator->swap_building;
+	dgaccelerator->swap_building = NULL;
+	// Values set since start and not swapped in yet are used by the next start
+	{
+		std::lock_guard< std::mutex > lock( *dgaccelerator->swap_mutex );
+		if( dgaccelerator->swap_model_name )
+			dgaccelerator->model_name = dgaccelerator->swap_model_name;
+		if( dgaccelerator->swap_server_ip )
+			dgaccelerator->server_ip = dgaccelerator->swap_server_ip;
+		dgaccelerator->swap_model_name = dgaccelerator->swap_server_ip = NULL;
+		dgaccelerator->models_started = FALSE;
+	}
+	if( dgaccelerator->retire_thread )
+	{
+		dgaccelerator->retire_thread->join();
+		delete dgaccelerator->retire_thread;
+		dgaccelerator->retire_thread = NULL;
+	}
+}
+
+///
+/// \brief Gets the class map of a segmentation result with class IDs of the given size
+///
+/// The parser writes class IDs in the format of the segmentation-output property, so the buffer is normally shared as
+/// is. It is only converted into a new buffer for results parsed before the property was changed.
+///
+/// \param[in] segmentation The segmentation result
+/// \param[in] element_size Size of the class IDs in bytes: 1 (uint8) or 4 (int32)
+/// \return The class map buffer
+///
+static DgAcceleratorMaskBuffer segmentationClassMap( const DgAcceleratorSegmentation &segmentation, size_t element_size )
+{
+	if( segmentation.element_size == element_size )
+		return segmentation.class_map;
+
+	return DgAcceleratorMaskConvert( segmentation.class_map.get(), segmentation.mask_width * segmentation.mask_height, segmentation.element_size, element_size );
+}
+
+///
+/// \brief Releases the given segmentation metadata.
+///
+/// The class map is not freed here: it belongs to the pooled buffer referenced by the placement in priv_data, which is
+/// returned to the mask pool once the last metadata copy sharing it is released.
+///
+/// \param[in] data A gpointer to the user meta data to be released.
+/// \param[in] user_data Unused, but required
+///
+static void releaseSegmentationMeta( gpointer data, gpointer user_data )
+{
+	if( data == nullptr )
+		return;
+
+	NvDsUserMeta *user_meta = (NvDsUserMeta *)data;
 	assert( user_meta != nullptr );
 	assert( user_meta->base_meta.meta_type == NVDSINFER_SEGMENTATION_META );
 
 	NvDsInferSegmentationMeta *segm_meta = (NvDsInferSegmentationMeta *)user_meta->user_meta_data;
 	if( segm_meta != nullptr )
 	{
-		if( segm_meta->class_map != nullptr )
-		{
-			delete[] segm_meta->class_map;  // Use delete[] to deallocate memory allocated with new[]
-			segm_meta->class_map = nullptr;
-		}
-
 		if( segm_meta->class_probabilities_map != nullptr )
 		{
 			delete[] segm_meta->class_probabilities_map;
 			segm_meta->class_probabilities_map = nullptr;
 		}
+
+		GstDgAcceleratorSegmentationMeta *placement = (GstDgAcceleratorSegmentationMeta *)segm_meta->priv_data;
+		if( placement != nullptr )
+		{
+			delete (DgAcceleratorMaskBuffer *)placement->priv_data;
+			delete placement;
+		}
 		delete segm_meta;
 		user_meta->user_meta_data = nullptr;
 	}
 }
+
 ///
-/// \brief Creates a deep copy of the given segmentation metadata.
+/// \brief Creates a copy of the given segmentation metadata.
 ///
-/// This function creates a deep copy of the given segmentation metadata. It first checks if the metadata is valid and if
-/// the class_map pointer is not null. If it is not null and the width, height, and classes fields are positive, it creates
-/// a new metadata object and sets its fields to the same values as the source metadata. It then allocates memory for the
-/// class_map using g_memdup() function and copies the data from the source class_map to the new class_map. Finally, it
-/// returns the new metadata object.
+/// The copy shares the class map buffer of the source by reference, so copying the metadata along with its buffer
+/// does not copy the class map.
 ///
 /// \param[in] data A gpointer to the user meta data to be copied.
 /// \param[in] user_data Unused, but required
@@ -1290,21 +3027,7 @@ static gpointer copySegmentationMeta( gpointer data, gpointer user_data )
 	NvDsInferSegmentationMeta *segm_meta = (NvDsInferSegmentationMeta *)user_meta->user_meta_data;
 	assert( segm_meta != nullptr );
 
-	NvDsInferSegmentationMeta *ret = new NvDsInferSegmentationMeta();
-	std::memset( ret, 0, sizeof *ret );
-
-	// copy the data to meta
-	ret->unique_id = segm_meta->unique_id;
-	ret->classes = segm_meta->classes;
-	ret->width = segm_meta->width;
-	ret->height = segm_meta->height;
-
-	if( segm_meta->class_map != nullptr )
-	{
-		const size_t class_map_cnt = segm_meta->width * segm_meta->height;
-		ret->class_map = new int[ class_map_cnt ];
-		std::memcpy( ret->class_map, segm_meta->class_map, class_map_cnt * sizeof( int ) );
-	}
+	NvDsInferSegmentationMeta *ret = new NvDsInferSegmentationMeta( *segm_meta );
 
 	if( segm_meta->class_probabilities_map != nullptr )
 	{
@@ -1313,23 +3036,33 @@ static gpointer copySegmentationMeta( gpointer data, gpointer user_data )
 		std::memcpy( ret->class_probabilities_map, segm_meta->class_probabilities_map, prob_map_cnt * sizeof( float ) );
 	}
 
+	const GstDgAcceleratorSegmentationMeta *placement = (GstDgAcceleratorSegmentationMeta *)segm_meta->priv_data;
+	if( placement != nullptr )
+	{
+		GstDgAcceleratorSegmentationMeta *placement_copy = new GstDgAcceleratorSegmentationMeta( *placement );
+		placement_copy->priv_data = new DgAcceleratorMaskBuffer( *(DgAcceleratorMaskBuffer *)placement->priv_data );
+		ret->priv_data = placement_copy;
+	}
+
 	return ret;
 }
 
 ///
 /// \brief Attaches segmentation metadata to a frame.
 ///
-/// This function attaches segmentation metadata to the given frame. It creates a new NvDsInferSegmentationMeta
-/// object and populates its fields with the provided frame number, width, height, and class map. The class map
-/// is deep-copied from the source array. The user metadata is then assigned to the segmentation metadata object.
+/// This function attaches an int32 NvDsInferSegmentationMeta to the given frame. Ownership of the pooled class map is
+/// handed over to the metadata: class_map points into the buffer, and priv_data holds a copy of the placement whose
+/// priv_data keeps a reference to the buffer.
 ///
 /// \param[in] frameMeta A pointer to the NvDsFrameMeta structure representing the frame.
 /// \param[in] frame_num The frame number to be assigned to the segmentation metadata.
-/// \param[in] width The width of the segmentation metadata.
-/// \param[in] height The height of the segmentation metadata.
-/// \param[in] class_map A pointer to the source array containing class map data.
+/// \param[in] class_map The class map buffer, with placement.width * placement.height int32 class IDs.
+/// \param[in] placement Resolution and placement of the class map on the frame.
 ///
-void attachSegmentationMetadata( NvDsFrameMeta *frameMeta, guint64 frame_num, int width, int height, const int *class_map )
+void attachSegmentationMetadata( NvDsFrameMeta *frameMeta,
+	guint64 frame_num,
+	const DgAcceleratorMaskBuffer &class_map,
+	const GstDgAcceleratorSegmentationMeta &placement )
 {
 	assert( frameMeta );
 	NvDsBatchMeta *batchMeta = frameMeta->base_meta.batch_meta;
@@ -1341,12 +3074,14 @@ void attachSegmentationMetadata( NvDsFrameMeta *frameMeta, guint64 frame_num, in
 	NvDsInferSegmentationMeta *segm_meta = new NvDsInferSegmentationMeta();
 	segm_meta->unique_id = frame_num;
 	segm_meta->classes = UINT_MAX;
-	segm_meta->width = width;
-	segm_meta->height = height;
-	segm_meta->class_map = new int[ width * height ];
-	std::memcpy( segm_meta->class_map, class_map, width * height * sizeof( int ) );
+	segm_meta->width = placement.width;
+	segm_meta->height = placement.height;
+	segm_meta->class_map = (gint *)class_map.get();
 	segm_meta->class_probabilities_map = nullptr;
-	segm_meta->priv_data = nullptr;
+	GstDgAcceleratorSegmentationMeta *placement_copy = new GstDgAcceleratorSegmentationMeta( placement );
+	placement_copy->class_map = nullptr;
+	placement_copy->priv_data = new DgAcceleratorMaskBuffer( class_map );
+	segm_meta->priv_data = placement_copy;
 
 	user_meta->user_meta_data = segm_meta;
 
@@ -1361,6 +3096,365 @@ void attachSegmentationMetadata( NvDsFrameMeta *frameMeta, guint64 frame_num, in
 	nvds_release_meta_lock( batchMeta );
 }
 
+///
+/// \brief Releases the given uint8 segmentation metadata, dropping its reference to the class map buffer.
+/// \param[in] data A gpointer to the user meta data to be released.
+/// \param[in] user_data Unused, but required
+///
+static void releaseSegmentationUint8Meta( gpointer data, gpointer user_data )
+{
+	if( data == nullptr )
+		return;
+
+	NvDsUserMeta *user_meta = (NvDsUserMeta *)data;
+	GstDgAcceleratorSegmentationMeta *segm_meta = (GstDgAcceleratorSegmentationMeta *)user_meta->user_meta_data;
+	if( segm_meta != nullptr )
+	{
+		delete (DgAcceleratorMaskBuffer *)segm_meta->priv_data;
+		delete segm_meta;
+		user_meta->user_meta_data = nullptr;
+	}
+}
+
+///
+/// \brief Creates a copy of the given uint8 segmentation metadata, sharing the class map buffer by reference.
+/// \param[in] data A gpointer to the user meta data to be copied.
+/// \param[in] user_data Unused, but required
+/// \return A gpointer to the newly created copy of the user meta data.
+///
+static gpointer copySegmentationUint8Meta( gpointer data, gpointer user_data )
+{
+	NvDsUserMeta *user_meta = (NvDsUserMeta *)data;
+	assert( user_meta != nullptr );
+
+	const GstDgAcceleratorSegmentationMeta *segm_meta = (GstDgAcceleratorSegmentationMeta *)user_meta->user_meta_data;
+	assert( segm_meta != nullptr );
+
+	GstDgAcceleratorSegmentationMeta *ret = new GstDgAcceleratorSegmentationMeta( *segm_meta );
+	ret->priv_data = new DgAcceleratorMaskBuffer( *(DgAcceleratorMaskBuffer *)segm_meta->priv_data );
+	return ret;
+}
+
+///
+/// \brief Attaches a uint8 class map at model resolution to a frame.
+///
+/// The map takes a quarter of the memory of an int32 NvDsInferSegmentationMeta map at the same resolution, class IDs
+/// are produced by the model as bytes so the narrowing is lossless. Ownership of the pooled class map is handed over
+/// to the metadata.
+///
+/// \param[in] frameMeta A pointer to the NvDsFrameMeta structure representing the frame.
+/// \param[in] class_map The class map buffer, with placement.width * placement.height uint8 class IDs.
+/// \param[in] placement Resolution and placement of the class map on the frame.
+///
+void attachSegmentationUint8Metadata( NvDsFrameMeta *frameMeta,
+	const DgAcceleratorMaskBuffer &class_map,
+	const GstDgAcceleratorSegmentationMeta &placement )
+{
+	static const NvDsMetaType meta_type = nvds_get_user_meta_type( const_cast< gchar * >( DGACCELERATOR_SEGMENTATION_META_TYPE_STRING ) );
+
+	assert( frameMeta );
+	NvDsBatchMeta *batchMeta = frameMeta->base_meta.batch_meta;
+
+	assert( batchMeta );
+	nvds_acquire_meta_lock( batchMeta );
+
+	NvDsUserMeta *user_meta = nvds_acquire_user_meta_from_pool( batchMeta );
+	GstDgAcceleratorSegmentationMeta *segm_meta = new GstDgAcceleratorSegmentationMeta( placement );
+	segm_meta->class_map = class_map.get();
+	segm_meta->priv_data = new DgAcceleratorMaskBuffer( class_map );
+
+	user_meta->user_meta_data = segm_meta;
+
+	user_meta->base_meta.meta_type = meta_type;
+	user_meta->base_meta.release_func = releaseSegmentationUint8Meta;
+	user_meta->base_meta.copy_func = copySegmentationUint8Meta;
+
+	nvds_add_user_meta_to_frame( frameMeta, user_meta );
+
+	nvds_release_meta_lock( batchMeta );
+}
+
+///
+/// \brief Releases the given segmentation statistics metadata.
+/// \param[in] data A gpointer to the user meta data to be released.
+/// \param[in] user_data Unused, but required
+///
+static void releaseSegmentationStatsMeta( gpointer data, gpointer user_data )
+{
+	if( data == nullptr )
+		return;
+
+	NvDsUserMeta *user_meta = (NvDsUserMeta *)data;
+	GstDgAcceleratorSegmentationStatsMeta *stats_meta = (GstDgAcceleratorSegmentationStatsMeta *)user_meta->user_meta_data;
+	if( stats_meta != nullptr )
+	{
+		delete[] stats_meta->classes;
+		delete stats_meta;
+		user_meta->user_meta_data = nullptr;
+	}
+}
+
+///
+/// \brief Creates a deep copy of the given segmentation statistics metadata.
+/// \param[in] data A gpointer to the user meta data to be copied.
+/// \param[in] user_data Unused, but required
+/// \return A gpointer to the newly created copy of the user meta data.
+///
+static gpointer copySegmentationStatsMeta( gpointer data, gpointer user_data )
+{
+	NvDsUserMeta *user_meta = (NvDsUserMeta *)data;
+	assert( user_meta != nullptr );
+
+	const GstDgAcceleratorSegmentationStatsMeta *stats_meta = (GstDgAcceleratorSegmentationStatsMeta *)user_meta->user_meta_data;
+	assert( stats_meta != nullptr );
+
+	GstDgAcceleratorSegmentationStatsMeta *ret = new GstDgAcceleratorSegmentationStatsMeta( *stats_meta );
+	ret->classes = new GstDgAcceleratorSegmentationClassStats[ stats_meta->num_classes ];
+	std::copy( stats_meta->classes, stats_meta->classes + stats_meta->num_classes, ret->classes );
+	return ret;
+}
+
+///
+/// \brief Attaches the per-class statistics of a class map to a frame, converted to frame coordinates.
+///
+/// Each entry takes a few tens of bytes, so consumers which only need the area, position and extent of the classes
+/// do not have to receive or scan the class map.
+///
+/// \param[in] frameMeta A pointer to the NvDsFrameMeta structure representing the frame.
+/// \param[in] stats Statistics of the classes in class map coordinates.
+/// \param[in] placement Resolution and placement of the class map on the frame.
+///
+void attachSegmentationStatsMetadata( NvDsFrameMeta *frameMeta,
+	const std::vector< DgAcceleratorClassStats > &stats,
+	const GstDgAcceleratorSegmentationMeta &placement )
+{
+	static const NvDsMetaType meta_type = nvds_get_user_meta_type( const_cast< gchar * >( DGACCELERATOR_SEGMENTATION_STATS_META_TYPE_STRING ) );
+
+	GstDgAcceleratorSegmentationStatsMeta *stats_meta = new GstDgAcceleratorSegmentationStatsMeta();
+	stats_meta->frame_num = placement.frame_num;
+	stats_meta->num_classes = stats.size();
+	stats_meta->classes = new GstDgAcceleratorSegmentationClassStats[ stats.size() ];
+	for( size_t i = 0; i < stats.size(); i++ )
+	{
+		// Mask pixel x covers frame pixels offset_x + x * scale_x to offset_x + ( x + 1 ) * scale_x
+		const DgAcceleratorClassStats &st = stats[ i ];
+		GstDgAcceleratorSegmentationClassStats &out = stats_meta->classes[ i ];
+		out.class_id = st.classId;
+		out.pixels = st.area;
+		out.area = st.area * placement.scale_x * placement.scale_y;
+		out.centroid_x = placement.offset_x + ( (double)st.sumX / st.area + 0.5 ) * placement.scale_x;
+		out.centroid_y = placement.offset_y + ( (double)st.sumY / st.area + 0.5 ) * placement.scale_y;
+		out.left = placement.offset_x + st.left * placement.scale_x;
+		out.top = placement.offset_y + st.top * placement.scale_y;
+		out.width = ( st.right - st.left + 1 ) * placement.scale_x;
+		out.height = ( st.bottom - st.top + 1 ) * placement.scale_y;
+	}
+
+	assert( frameMeta );
+	NvDsBatchMeta *batchMeta = frameMeta->base_meta.batch_meta;
+
+	assert( batchMeta );
+	nvds_acquire_meta_lock( batchMeta );
+
+	NvDsUserMeta *user_meta = nvds_acquire_user_meta_from_pool( batchMeta );
+	user_meta->user_meta_data = stats_meta;
+
+	user_meta->base_meta.meta_type = meta_type;
+	user_meta->base_meta.release_func = releaseSegmentationStatsMeta;
+	user_meta->base_meta.copy_func = copySegmentationStatsMeta;
+
+	nvds_add_user_meta_to_frame( frameMeta, user_meta );
+
+	nvds_release_meta_lock( batchMeta );
+}
+
+///
+/// \brief Releases the given segmentation polygons metadata.
+/// \param[in] data A gpointer to the user meta data to be released.
+/// \param[in] user_data Unused, but required
+///
+static void releaseSegmentationPolygonsMeta( gpointer data, gpointer user_data )
+{
+	if( data == nullptr )
+		return;
+
+	NvDsUserMeta *user_meta = (NvDsUserMeta *)data;
+	GstDgAcceleratorSegmentationPolygonsMeta *polygons_meta = (GstDgAcceleratorSegmentationPolygonsMeta *)user_meta->user_meta_data;
+	if( polygons_meta != nullptr )
+	{
+		delete[] polygons_meta->polygons;
+		delete[] polygons_meta->points;
+		delete polygons_meta;
+		user_meta->user_meta_data = nullptr;
+	}
+}
+
+///
+/// \brief Creates a deep copy of the given segmentation polygons metadata.
+/// \param[in] data A gpointer to the user meta data to be copied.
+/// \param[in] user_data Unused, but required
+/// \return A gpointer to the newly created copy of the user meta data.
+///
+static gpointer copySegmentationPolygonsMeta( gpointer data, gpointer user_data )
+{
+	NvDsUserMeta *user_meta = (NvDsUserMeta *)data;
+	assert( user_meta != nullptr );
+
+	const GstDgAcceleratorSegmentationPolygonsMeta *polygons_meta = (GstDgAcceleratorSegmentationPolygonsMeta *)user_meta->user_meta_data;
+	assert( polygons_meta != nullptr );
+
+	guint num_values = 0;
+	for( guint p = 0; p < polygons_meta->num_polygons; p++ )
+		num_values += 2 * polygons_meta->polygons[ p ].num_points;
+
+	GstDgAcceleratorSegmentationPolygonsMeta *ret = new GstDgAcceleratorSegmentationPolygonsMeta( *polygons_meta );
+	ret->polygons = new GstDgAcceleratorSegmentationPolygon[ polygons_meta->num_polygons ];
+	ret->points = new gfloat[ num_values ];
+	std::copy( polygons_meta->points, polygons_meta->points + num_values, ret->points );
+	for( guint p = 0; p < polygons_meta->num_polygons; p++ )
+	{
+		// Vertices of the copy point into its own storage, at the same offsets
+		ret->polygons[ p ] = polygons_meta->polygons[ p ];
+		ret->polygons[ p ].points = ret->points + ( polygons_meta->polygons[ p ].points - polygons_meta->points );
+	}
+	return ret;
+}
+
+///
+/// \brief Attaches the polygons of the regions of a class map to a frame, converted to frame coordinates.
+///
+/// The vertices of all polygons are stored in a single array, a few hundred bytes for typical scenes instead of the
+/// megabytes of a dense class map.
+///
+/// \param[in] frameMeta A pointer to the NvDsFrameMeta structure representing the frame.
+/// \param[in] polygons Polygons in class map coordinates.
+/// \param[in] placement Resolution and placement of the class map on the frame.
+/// \return The attached metadata, owned by the frame.
+///
+GstDgAcceleratorSegmentationPolygonsMeta *attachSegmentationPolygonsMetadata( NvDsFrameMeta *frameMeta,
+	const std::vector< DgAcceleratorPolygon > &polygons,
+	const GstDgAcceleratorSegmentationMeta &placement )
+{
+	static const NvDsMetaType meta_type = nvds_get_user_meta_type( const_cast< gchar * >( DGACCELERATOR_SEGMENTATION_POLYGONS_META_TYPE_STRING ) );
+
+	size_t num_values = 0;
+	for( const DgAcceleratorPolygon &polygon : polygons )
+		num_values += 2 * polygon.points.size();
+
+	GstDgAcceleratorSegmentationPolygonsMeta *polygons_meta = new GstDgAcceleratorSegmentationPolygonsMeta();
+	polygons_meta->frame_num = placement.frame_num;
+	polygons_meta->num_polygons = polygons.size();
+	polygons_meta->polygons = new GstDgAcceleratorSegmentationPolygon[ polygons.size() ];
+	polygons_meta->points = new gfloat[ num_values ];
+	gfloat *values = polygons_meta->points;
+	for( size_t p = 0; p < polygons.size(); p++ )
+	{
+		GstDgAcceleratorSegmentationPolygon &out = polygons_meta->polygons[ p ];
+		out.class_id = polygons[ p ].classId;
+		out.num_points = polygons[ p ].points.size();
+		out.points = values;
+		// Vertices are at the centers of the class map pixels
+		for( const cv::Point &point : polygons[ p ].points )
+		{
+			*values++ = placement.offset_x + ( point.x + 0.5f ) * placement.scale_x;
+			*values++ = placement.offset_y + ( point.y + 0.5f ) * placement.scale_y;
+		}
+	}
+
+	assert( frameMeta );
+	NvDsBatchMeta *batchMeta = frameMeta->base_meta.batch_meta;
+
+	assert( batchMeta );
+	nvds_acquire_meta_lock( batchMeta );
+
+	NvDsUserMeta *user_meta = nvds_acquire_user_meta_from_pool( batchMeta );
+	user_meta->user_meta_data = polygons_meta;
+
+	user_meta->base_meta.meta_type = meta_type;
+	user_meta->base_meta.release_func = releaseSegmentationPolygonsMeta;
+	user_meta->base_meta.copy_func = copySegmentationPolygonsMeta;
+
+	nvds_add_user_meta_to_frame( frameMeta, user_meta );
+
+	nvds_release_meta_lock( batchMeta );
+	return polygons_meta;
+}
+
+///
+/// \brief Releases the given pose metadata.
+/// \param[in] data A gpointer to the user meta data to be released.
+/// \param[in] user_data Unused, but required
+///
+static void releasePoseMeta( gpointer data, gpointer user_data )
+{
+	if( data == nullptr )
+		return;
+
+	NvDsUserMeta *user_meta = (NvDsUserMeta *)data;
+	GstDgAcceleratorPoseMeta *pose_meta = (GstDgAcceleratorPoseMeta *)user_meta->user_meta_data;
+	if( pose_meta != nullptr )
+	{
+		delete[] pose_meta->keypoints;
+		delete pose_meta;
+		user_meta->user_meta_data = nullptr;
+	}
+}
+
+///
+/// \brief Creates a deep copy of the given pose metadata.
+/// \param[in] data A gpointer to the user meta data to be copied.
+/// \param[in] user_data Unused, but required
+/// \return A gpointer to the newly created copy of the user meta data.
+///
+static gpointer copyPoseMeta( gpointer data, gpointer user_data )
+{
+	NvDsUserMeta *user_meta = (NvDsUserMeta *)data;
+	assert( user_meta != nullptr );
+
+	const GstDgAcceleratorPoseMeta *pose_meta = (GstDgAcceleratorPoseMeta *)user_meta->user_meta_data;
+	assert( pose_meta != nullptr );
+
+	GstDgAcceleratorPoseMeta *ret = new GstDgAcceleratorPoseMeta( *pose_meta );
+	ret->keypoints = new GstDgAcceleratorPoseKeypoint[ pose_meta->num_keypoints ];
+	std::copy( pose_meta->keypoints, pose_meta->keypoints + pose_meta->num_keypoints, ret->keypoints );
+	return ret;
+}
+
+///
+/// \brief Attaches the keypoints of a pose to the object of the pose.
+/// \param[in] objectMeta A pointer to the NvDsObjectMeta of the pose, already added to its frame.
+/// \param[in] frame_num Frame number of the inferred buffer.
+/// \param[in] keypoints Keypoints in frame coordinates, copied into the metadata.
+/// \param[in] num_keypoints Number of keypoints.
+///
+void attachPoseMetadata( NvDsObjectMeta *objectMeta, guint64 frame_num, const GstDgAcceleratorPoseKeypoint *keypoints, guint num_keypoints )
+{
+	static const NvDsMetaType meta_type = nvds_get_user_meta_type( const_cast< gchar * >( DGACCELERATOR_POSE_META_TYPE_STRING ) );
+
+	GstDgAcceleratorPoseMeta *pose_meta = new GstDgAcceleratorPoseMeta();
+	pose_meta->frame_num = frame_num;
+	pose_meta->num_keypoints = num_keypoints;
+	pose_meta->keypoints = new GstDgAcceleratorPoseKeypoint[ num_keypoints ];
+	std::copy( keypoints, keypoints + num_keypoints, pose_meta->keypoints );
+
+	assert( objectMeta );
+	NvDsBatchMeta *batchMeta = objectMeta->base_meta.batch_meta;
+
+	assert( batchMeta );
+	nvds_acquire_meta_lock( batchMeta );
+
+	NvDsUserMeta *user_meta = nvds_acquire_user_meta_from_pool( batchMeta );
+	user_meta->user_meta_data = pose_meta;
+
+	user_meta->base_meta.meta_type = meta_type;
+	user_meta->base_meta.release_func = releasePoseMeta;
+	user_meta->base_meta.copy_func = copyPoseMeta;
+
+	nvds_add_user_meta_to_obj( objectMeta, user_meta );
+
+	nvds_release_meta_lock( batchMeta );
+}
+
 ///
 /// \brief Initializes the GstDgAccelerator plugin
 ///
@@ -28,7 +28,14 @@
 
 #define MAX_LABEL_SIZE 128
 
+#include <atomic>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
 // Degirum
 #include "dg_model_parameters.h"
 #include "dgaccelerator_lib.h"
@@ -81,6 +88,42 @@ typedef enum
 	DGACCELERATOR_BOX_COLOR_BLACK
 } GstDgAcceleratorBoxColor;
 
+// Possible values for process-mode property.
+typedef enum
+{
+	DGACCELERATOR_PROCESS_MODE_PRIMARY,   // Infer full frames
+	DGACCELERATOR_PROCESS_MODE_SECONDARY  // Infer objects detected upstream
+} GstDgAcceleratorProcessMode;
+
+// Possible values for segmentation-output property.
+typedef enum
+{
+	DGACCELERATOR_SEGMENTATION_OUTPUT_FRAME,        // NvDsInferSegmentationMeta upscaled to frame resolution
+	DGACCELERATOR_SEGMENTATION_OUTPUT_MODEL,        // NvDsInferSegmentationMeta at model resolution, scale info in priv_data
+	DGACCELERATOR_SEGMENTATION_OUTPUT_MODEL_UINT8,  // GstDgAcceleratorSegmentationMeta with a uint8 class map at model resolution
+	DGACCELERATOR_SEGMENTATION_OUTPUT_POLYGONS,     // GstDgAcceleratorSegmentationPolygonsMeta and display meta outlines of the regions
+	DGACCELERATOR_SEGMENTATION_OUTPUT_NONE          // No class map, with segmentation-stats only the statistics are attached
+} GstDgAcceleratorSegmentationOutput;
+
+/// \brief Additional model hosted by the element, parsed from the extra-models property
+struct GstDgAcceleratorModel
+{
+	std::string name;        //!< The full name of the model
+	gint width;              //!< Processing width of the model
+	gint height;             //!< Processing height of the model
+	gdouble conf_threshold;  //!< Output confidence threshold, negative to use the output-conf-threshold property
+	gint frame;              //!< Index of the model whose resized frame is used, -1 for the frame at processing resolution
+	cv::Mat *cvmat;          //!< Frame resized to the resolution of the model, NULL when the frame of another model is used
+	DgAcceleratorCtx *ctx;   //!< Context of the DG model library for this model
+};
+
+/// \brief Contexts built by a model swap in PLAYING state, replacing the current ones together
+struct GstDgAcceleratorSwap
+{
+	DgAcceleratorCtx *ctx;                     //!< Context of model-name
+	std::vector< DgAcceleratorCtx * > models;  //!< Contexts of the additional models, in the order of model_list
+};
+
 /// \brief Structure for the dgaccelerator element
 struct _GstDgAccelerator
 {
@@ -101,9 +144,36 @@ struct _GstDgAccelerator
 	char *model_name;                                               //!< The full name of the model to be used for inference
 	char *server_ip;                                                //!< The server ip address to connect to for running inference
 	char *cloud_token;                                              //!< The token needed to allow connection to cloud models
+	char *zoo_cache_dir;                                            //!< Directory where model zoo listings are persisted, empty if disabled
+	guint connections;                                              //!< Number of model instances opened on each server
+	gboolean share_connection;                                      //!< Flag indicating whether model instances are shared with other elements of the process
+	gboolean async_start;                                           //!< Flag indicating whether models are initialized on a background thread
+	guint warm_up_frames;                                           //!< Number of blank frames inferred by each model instance at startup
+	std::thread *init_thread;                                       //!< Thread initializing the models when async_start is set
+	std::string *init_error;                                        //!< Error of the model initialization on init_thread, empty on success
 	bool drop_frames;                                               //!< Skip frames toggle
 	GstDgAcceleratorBoxColor box_color;                             //!< Box Color for visualization
 	NvOSD_ColorParams color = ( NvOSD_ColorParams ){ 1, 0, 0, 1 };  //!< Box Color converted into a NvOSD_ColorParams (default red)
+	char *roi;                                                      //!< Per-source regions of interest, as set by the roi property
+	std::map< guint, NvOSD_RectParams > *roi_map;                   //!< Regions of interest parsed from roi, by source ID
+	GstDgAcceleratorProcessMode process_mode;                       //!< Whether full frames or upstream objects are inferred
+	std::set< gint > *class_ids;                                    //!< Class IDs parsed from operate-on-class-ids, empty for all
+	std::set< gint > *class_filter_ids;                             //!< Class IDs parsed from class-filter, empty for all
+	char *extra_models;                                             //!< Additional models, as set by the extra-models property
+	std::vector< GstDgAcceleratorModel > *model_list;               //!< Additional models parsed from extra-models
+	std::mutex *swap_mutex;                                         //!< Guards model_name, server_ip, models_started and the swap_* values set by the application
+	gboolean models_started;                                        //!< Flag set between start and stop, when model_name and server_ip are only changed by the streaming thread
+	char *swap_model_name;                                          //!< model-name set since start, to be swapped in by the streaming thread, NULL if unchanged
+	char *swap_server_ip;                                           //!< server_ip set since start, to be swapped in by the streaming thread, NULL if unchanged
+	std::thread *swap_thread;                                       //!< Thread building the model set in PLAYING state by model-name or server_ip
+	std::atomic< bool > *swap_building;                             //!< Flag set while swap_thread builds the model set
+	std::atomic< GstDgAcceleratorSwap * > *swap_ctx;                //!< Warmed up contexts built by swap_thread, waiting to replace the current ones
+	std::thread *retire_thread;                                     //!< Thread draining and deinitializing the replaced contexts
+	GstDgAcceleratorSegmentationOutput segmentation_output;         //!< Resolution and format of the attached segmentation class maps
+	gboolean segmentation_stats;                                    //!< Flag indicating whether per-class statistics of segmentation class maps are attached
+	gdouble polygon_tolerance;                                      //!< Simplification tolerance of segmentation polygons, in class map pixels
+	gboolean draw;                                                  //!< Flag indicating whether results are decorated for nvdsosd (box borders, display text, display meta)
+	gboolean share_frames;                                          //!< Flag indicating whether converted frames are attached to the buffer for downstream elements
 
 	/// \brief model parameters struct
 	struct
@@ -120,6 +190,62 @@ struct _GstDgAccelerator
 		gint max_classes_per_detection;  //!< Maximum number of classes per detection
 		gboolean use_regular_nms;        //!< Flag indicating whether to use regular NMS
 	} model_params;
+
+	/// \brief built-in tracker parameters struct
+	struct
+	{
+		gboolean enable;        //!< Flag indicating whether to track objects and extrapolate them on frames without new results
+		gdouble iou_threshold;  //!< Minimum IoU to associate a detection with a track
+		guint max_age;          //!< Number of frames a track survives without a matched detection
+	} tracker_params;
+
+	/// \brief motion gate parameters struct
+	struct
+	{
+		gdouble threshold;      //!< Fraction of changed pixels needed to run inference, 0 disables the gate
+		guint pixel_threshold;  //!< Minimum intensity difference for a pixel to count as changed
+		guint max_skip;         //!< Maximum number of consecutive frames held back
+	} motion_params;
+
+	/// \brief near-duplicate frame result cache parameters struct
+	struct
+	{
+		guint cache_size;         //!< Number of results kept per source, 0 disables the cache
+		guint hamming_threshold;  //!< Maximum number of differing hash bits between duplicate frames
+		guint max_reuse;          //!< Maximum number of frames served by one cached result
+	} dedup_params;
+
+	/// \brief result filter parameters struct
+	struct
+	{
+		gchar *class_filter;     //!< Class IDs of the results to attach, separated by ';'
+		gdouble min_confidence;  //!< Minimum confidence of the results to attach
+		guint min_box_size;      //!< Minimum width and height of the detections to attach, in processing resolution pixels
+	} filter_params;
+
+	/// \brief tiling parameters struct
+	struct
+	{
+		gboolean enable;        //!< Flag indicating whether to infer frames as overlapping tiles
+		gdouble overlap;        //!< Minimum overlap between neighbouring tiles, as a fraction of the tile size
+		gdouble nms_threshold;  //!< Overlap above which detections of the same class from different tiles are merged
+	} tiling_params;
+
+	/// \brief secondary mode parameters struct
+	struct
+	{
+		gchar *operate_on_class_ids;  //!< Class IDs of the upstream objects to infer, separated by ';'
+		guint min_width;              //!< Minimum width of the upstream objects to infer
+		guint min_height;             //!< Minimum height of the upstream objects to infer
+		guint reinfer_interval;       //!< Number of frames during which the results of a tracked object are reused
+	} secondary_params;
+
+	/// \brief server reconnection parameters struct
+	struct
+	{
+		gboolean enable;  //!< Flag indicating whether server errors are survived by reconnecting instead of stopping the pipeline
+		guint max_delay;  //!< Maximum delay between reconnection attempts, in milliseconds
+	} reconnect_params;
 };
 
 /// \brief GStreamer boilerplate structure
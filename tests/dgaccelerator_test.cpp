@@ -7,11 +7,24 @@
 /// This file contains implementation of unit tests 
 /// for testing dgaccelerator plugin in DeepStream pipelines
 ///
+#include <atomic>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <map>
 #include <thread>
 #include "gtest/gtest.h"
 #include "../dgaccelerator/gstdgaccelerator.h"
+#include "../dgaccelerator/dgaccelerator_dedup.h"
+#include "../dgaccelerator/dgaccelerator_labels.h"
 #include "../dgaccelerator/dgaccelerator_lib.h"
+#include "../dgaccelerator/dgaccelerator_mask.h"
+#include "../dgaccelerator/dgaccelerator_meta.h"
+#include "../dgaccelerator/dgaccelerator_motion.h"
+#include "../dgaccelerator/dgaccelerator_registry.h"
+#include "../dgaccelerator/dgaccelerator_tiling.h"
+#include "../dgaccelerator/dgaccelerator_tracker.h"
 
 // Define constants and data structures for the test cases
 #define TEST_SERVER_IP "192.168.0.141"
@@ -189,6 +202,20 @@ TEST_F(GStreamerPluginTest, RunTestPipelines) {
 	// 4 : dgaccelerator on mp4 video with pose estimation
 	// 5 : dgaccelerator on mp4 video with classification
 	// 6 : dgaccelerator on mp4 video with segmentation
+	// 7 : dgaccelerator on mp4 video with a region of interest and box drawing
+	// 8 : dgaccelerator on mp4 video with tiling and box drawing
+	// 9 : dgaccelerator detector and tracker followed by a secondary dgaccelerator classifier
+	// 10 : dgaccelerator hosting a segmentation model and a detection model on the same converted frames
+	// 11 : dgaccelerator balancing frames of two videos across two connections to the server
+	// 12 : dgaccelerator reconnecting failed servers instead of stopping the pipeline
+	// 13 : two dgaccelerator elements initializing and warming up their models in parallel
+	// 14 : two dgaccelerator elements sharing one model instance
+	// 15 : dgaccelerator attaching segmentation maps at model resolution, upscaled by nvsegvisual
+	// 16 : dgaccelerator attaching per-class segmentation statistics without class maps
+	// 17 : dgaccelerator attaching segmentation polygons, drawn by nvdsosd
+	// 18 : dgaccelerator attaching undecorated detections and classifications to a pipeline without on-screen display
+	// 19 : dgaccelerator attaching only confident, large enough detections of selected classes
+	// 20 : dgaccelerator sharing its converted frames with dgaccelerator elements in two branches of a tee
 	const gchar *pipelines[] = {
 		"fakesrc ! fakesink",
 		"videotestsrc ! nvvideoconvert ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 ! queue ! identity ! fakesink enable-last-sample=0",
@@ -197,6 +224,20 @@ TEST_F(GStreamerPluginTest, RunTestPipelines) {
 		"nvurisrcbin file-loop=true uri=file:///opt/nvidia/deepstream/deepstream-6.2/samples/streams/sample_ride_bike.mov ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 ! queue ! dgaccelerator processing-width=481 processing-height=353 server_ip=" TEST_SERVER_IP " model-name=mobilenet_v1_posenet_coco_keypoints--353x481_quant_n2x_orca_1 drop-frames=false ! nvdsosd ! fakesink enable-last-sample=0",
 		"nvurisrcbin file-loop=true uri=file:///opt/nvidia/deepstream/deepstream-6.2/samples/streams/sample_ride_bike.mov ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 ! queue ! dgaccelerator processing-width=224 processing-height=224 server_ip=" TEST_SERVER_IP " model-name=resnet50_imagenet--224x224_pruned_quant_n2x_orca_1 drop-frames=false ! nvdsosd ! fakesink enable-last-sample=0",
 		"nvurisrcbin file-loop=true uri=file:///opt/nvidia/deepstream/deepstream-6.2/samples/streams/sample_1080p_h264.mp4 ! videorate drop-only=true max-rate=18 ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 ! queue ! dgaccelerator processing-width=513 processing-height=513 server_ip=" TEST_SERVER_IP " model-name=deeplab_seg--513x513_quant_n2x_orca_1 drop-frames=false ! nvsegvisual width=1920 height=1080 ! fakesink enable-last-sample=0",
+		"nvurisrcbin uri=file:///opt/nvidia/deepstream/deepstream-6.2/samples/streams/sample_1080p_h264.mp4 ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 ! dgaccelerator processing-width=300 processing-height=300 server_ip=" TEST_SERVER_IP " model-name=mobilenet_v2_ssd_coco--300x300_quant_n2x_orca_1 drop-frames=false roi=\"0:480,270,960,810\" ! nvvideoconvert ! nvdsosd ! fakesink enable-last-sample=0",
+		"nvurisrcbin uri=file:///opt/nvidia/deepstream/deepstream-6.2/samples/streams/sample_1080p_h264.mp4 ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 ! dgaccelerator processing-width=512 processing-height=512 server_ip=" TEST_SERVER_IP " model-name=yolo_v5s_coco--512x512_quant_n2x_orca_1 drop-frames=true tiling=true ! nvvideoconvert ! nvdsosd ! fakesink enable-last-sample=0",
+		"nvurisrcbin uri=file:///opt/nvidia/deepstream/deepstream-6.2/samples/streams/sample_1080p_h264.mp4 ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 ! dgaccelerator processing-width=300 processing-height=300 server_ip=" TEST_SERVER_IP " model-name=mobilenet_v2_ssd_coco--300x300_quant_n2x_orca_1 drop-frames=false tracker=true ! dgaccelerator unique-id=2 process-mode=secondary processing-width=224 processing-height=224 server_ip=" TEST_SERVER_IP " model-name=resnet50_imagenet--224x224_pruned_quant_n2x_orca_1 drop-frames=false input-object-min-width=32 input-object-min-height=32 ! nvvideoconvert ! nvdsosd ! fakesink enable-last-sample=0",
+		"nvurisrcbin uri=file:///opt/nvidia/deepstream/deepstream-6.2/samples/streams/sample_1080p_h264.mp4 ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 ! dgaccelerator processing-width=513 processing-height=513 server_ip=" TEST_SERVER_IP " model-name=deeplab_seg--513x513_quant_n2x_orca_1 extra-models=\"mobilenet_v2_ssd_coco--300x300_quant_n2x_orca_1:300,300,0.3\" drop-frames=false ! nvsegvisual width=1920 height=1080 ! fakesink enable-last-sample=0",
+		"nvurisrcbin uri=file:///opt/nvidia/deepstream/deepstream-6.2/samples/streams/sample_1080p_h264.mp4 ! m.sink_0 nvurisrcbin uri=file:///opt/nvidia/deepstream/deepstream-6.2/samples/streams/sample_1080p_h264.mp4 ! m.sink_1 nvstreammux name=m batch-size=2 width=1920 height=1080 ! dgaccelerator processing-width=300 processing-height=300 server_ip=" TEST_SERVER_IP "," TEST_SERVER_IP " model-name=mobilenet_v2_ssd_coco--300x300_quant_n2x_orca_1 drop-frames=false ! fakesink enable-last-sample=0",
+		"nvurisrcbin uri=file:///opt/nvidia/deepstream/deepstream-6.2/samples/streams/sample_1080p_h264.mp4 ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 ! dgaccelerator processing-width=300 processing-height=300 server_ip=" TEST_SERVER_IP " model-name=mobilenet_v2_ssd_coco--300x300_quant_n2x_orca_1 drop-frames=false reconnect=true reconnect-max-delay=2000 ! fakesink enable-last-sample=0",
+		"nvurisrcbin uri=file:///opt/nvidia/deepstream/deepstream-6.2/samples/streams/sample_1080p_h264.mp4 ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 ! dgaccelerator processing-width=300 processing-height=300 server_ip=" TEST_SERVER_IP " model-name=mobilenet_v2_ssd_coco--300x300_quant_n2x_orca_1 drop-frames=false async-start=true warm-up-frames=2 ! dgaccelerator unique-id=2 processing-width=513 processing-height=513 server_ip=" TEST_SERVER_IP " model-name=deeplab_seg--513x513_quant_n2x_orca_1 drop-frames=false async-start=true warm-up-frames=2 ! fakesink enable-last-sample=0",
+		"nvurisrcbin uri=file:///opt/nvidia/deepstream/deepstream-6.2/samples/streams/sample_1080p_h264.mp4 ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 ! dgaccelerator processing-width=300 processing-height=300 server_ip=" TEST_SERVER_IP " model-name=mobilenet_v2_ssd_coco--300x300_quant_n2x_orca_1 drop-frames=false share-connection=true ! dgaccelerator unique-id=2 processing-width=300 processing-height=300 server_ip=" TEST_SERVER_IP " model-name=mobilenet_v2_ssd_coco--300x300_quant_n2x_orca_1 drop-frames=false share-connection=true ! fakesink enable-last-sample=0",
+		"nvurisrcbin uri=file:///opt/nvidia/deepstream/deepstream-6.2/samples/streams/sample_1080p_h264.mp4 ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 ! dgaccelerator processing-width=513 processing-height=513 server_ip=" TEST_SERVER_IP " model-name=deeplab_seg--513x513_quant_n2x_orca_1 drop-frames=false segmentation-output=model ! nvsegvisual width=1920 height=1080 ! fakesink enable-last-sample=0",
+		"nvurisrcbin uri=file:///opt/nvidia/deepstream/deepstream-6.2/samples/streams/sample_1080p_h264.mp4 ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 ! dgaccelerator processing-width=513 processing-height=513 server_ip=" TEST_SERVER_IP " model-name=deeplab_seg--513x513_quant_n2x_orca_1 drop-frames=false segmentation-output=none segmentation-stats=true ! fakesink enable-last-sample=0",
+		"nvurisrcbin uri=file:///opt/nvidia/deepstream/deepstream-6.2/samples/streams/sample_1080p_h264.mp4 ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 ! dgaccelerator processing-width=513 processing-height=513 server_ip=" TEST_SERVER_IP " model-name=deeplab_seg--513x513_quant_n2x_orca_1 drop-frames=false segmentation-output=polygons polygon-tolerance=2 ! nvvideoconvert ! nvdsosd ! fakesink enable-last-sample=0",
+		"nvurisrcbin uri=file:///opt/nvidia/deepstream/deepstream-6.2/samples/streams/sample_1080p_h264.mp4 ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 ! dgaccelerator processing-width=300 processing-height=300 server_ip=" TEST_SERVER_IP " model-name=mobilenet_v2_ssd_coco--300x300_quant_n2x_orca_1 drop-frames=false draw=false ! dgaccelerator unique-id=2 process-mode=secondary processing-width=224 processing-height=224 server_ip=" TEST_SERVER_IP " model-name=resnet50_imagenet--224x224_pruned_quant_n2x_orca_1 drop-frames=false draw=false ! fakesink enable-last-sample=0",
+		"nvurisrcbin uri=file:///opt/nvidia/deepstream/deepstream-6.2/samples/streams/sample_1080p_h264.mp4 ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 ! dgaccelerator processing-width=300 processing-height=300 server_ip=" TEST_SERVER_IP " model-name=mobilenet_v2_ssd_coco--300x300_quant_n2x_orca_1 drop-frames=false class-filter=\"1;3\" min-confidence=0.5 min-box-size=16 ! nvvideoconvert ! nvdsosd ! fakesink enable-last-sample=0",
+		"nvurisrcbin uri=file:///opt/nvidia/deepstream/deepstream-6.2/samples/streams/sample_1080p_h264.mp4 ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 ! dgaccelerator processing-width=300 processing-height=300 server_ip=" TEST_SERVER_IP " model-name=mobilenet_v2_ssd_coco--300x300_quant_n2x_orca_1 drop-frames=false share-frames=true ! tee name=t t. ! queue ! dgaccelerator unique-id=2 processing-width=300 processing-height=300 server_ip=" TEST_SERVER_IP " model-name=mobilenet_v2_ssd_coco--300x300_quant_n2x_orca_1 drop-frames=false ! fakesink enable-last-sample=0 t. ! queue ! dgaccelerator unique-id=3 processing-width=300 processing-height=300 server_ip=" TEST_SERVER_IP " model-name=mobilenet_v2_ssd_coco--300x300_quant_n2x_orca_1 drop-frames=false ! fakesink enable-last-sample=0",
 		NULL
 	};
 
@@ -344,6 +385,589 @@ TEST_F( GStreamerPluginTest, PropertyValidationPipelines )
 	gst_object_unref( pipeline5 );
 }
 
+// Test that changing model-name in PLAYING state switches the element and its extra models without interrupting the stream
+TEST_F( GStreamerPluginTest, ModelSwapInPlaying )
+{
+	GstElement *pipeline = gst_parse_launch(
+		"videotestsrc is-live=true num-buffers=600 ! nvvideoconvert ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 live-source=1 ! "
+		"dgaccelerator name=dg processing-width=300 processing-height=300 server_ip=" TEST_SERVER_IP " model-name=mobilenet_v2_ssd_coco--300x300_quant_n2x_orca_1 "
+		"extra-models=resnet50_imagenet--224x224_pruned_quant_n2x_orca_1:224,224 drop-frames=false ! fakesink enable-last-sample=0",
+		NULL );
+	ASSERT_TRUE( pipeline != NULL );
+	GstBus *bus = gst_element_get_bus( pipeline );
+	gst_element_set_state( pipeline, GST_STATE_PLAYING );
+	g_usleep( 3 * G_USEC_PER_SEC );  // Let frames flow through the current models
+
+	// Load a new instance of the model while frames keep flowing
+	GstElement *dgaccelerator = gst_bin_get_by_name( GST_BIN( pipeline ), "dg" );
+	ASSERT_TRUE( dgaccelerator != NULL );
+	g_object_set( dgaccelerator, "model-name", "mobilenet_v2_ssd_coco--300x300_quant_n2x_orca_1", NULL );
+
+	// The element posts an info message once it switched, and the stream then runs to its end
+	bool switched = false;
+	for( ;; )
+	{
+		GstMessage *msg = gst_bus_timed_pop_filtered(
+			bus, 60 * GST_SECOND, (GstMessageType)( GST_MESSAGE_INFO | GST_MESSAGE_WARNING | GST_MESSAGE_ERROR | GST_MESSAGE_EOS ) );
+		ASSERT_TRUE( msg != NULL );
+		const GstMessageType type = GST_MESSAGE_TYPE( msg );
+		if( type == GST_MESSAGE_INFO && GST_MESSAGE_SRC( msg ) == GST_OBJECT( dgaccelerator ) )
+			switched = true;
+		EXPECT_NE( type, GST_MESSAGE_WARNING );
+		EXPECT_NE( type, GST_MESSAGE_ERROR );
+		gst_message_unref( msg );
+		if( type != GST_MESSAGE_INFO )
+			break;
+	}
+	EXPECT_TRUE( switched );
+
+	gst_object_unref( dgaccelerator );
+	gst_object_unref( bus );
+	gst_element_set_state( pipeline, GST_STATE_NULL );
+	gst_object_unref( pipeline );
+}
+
+// Buffers reaching the sink of a benchmark pipeline, with the times of the first timed and of the last buffer
+struct BenchmarkTimes
+{
+	guint warmUp;   // Buffers let through before timing starts, filling the pipeline and the outstanding requests
+	guint buffers;  // Buffers received
+	gint64 start;   // Time of the first timed buffer
+	gint64 end;     // Time of the last buffer
+};
+
+// Benchmark the throughput of one element with several connections to the server
+TEST_F( GStreamerPluginTest, ConnectionsBenchmark )
+{
+	const guint numFrames = 300;
+	const guint warmUp = 30;
+	std::map< guint, double > fps;
+	for( guint connections : { 1, 2, 4 } )
+	{
+		gchar *description = g_strdup_printf(
+			"videotestsrc num-buffers=%u ! nvvideoconvert ! m.sink_0 nvstreammux name=m batch-size=1 width=1920 height=1080 ! dgaccelerator "
+			"processing-width=300 processing-height=300 server_ip=" TEST_SERVER_IP " model-name=mobilenet_v2_ssd_coco--300x300_quant_n2x_orca_1 "
+			"drop-frames=false connections=%u ! fakesink name=sink sync=false enable-last-sample=0",
+			numFrames,
+			connections );
+		GstElement *pipeline = gst_parse_launch( description, NULL );
+		g_free( description );
+		ASSERT_TRUE( pipeline != NULL );
+
+		// Time the buffers leaving the element once connections are made, models are loaded and requests are in flight
+		BenchmarkTimes times = { warmUp, 0, 0, 0 };
+		GstElement *sink = gst_bin_get_by_name( GST_BIN( pipeline ), "sink" );
+		GstPad *pad = gst_element_get_static_pad( sink, "sink" );
+		gst_pad_add_probe(
+			pad,
+			GST_PAD_PROBE_TYPE_BUFFER,
+			[]( GstPad *, GstPadProbeInfo *, gpointer data ) -> GstPadProbeReturn {
+				BenchmarkTimes *times = (BenchmarkTimes *)data;
+				const gint64 now = g_get_monotonic_time();
+				if( ++times->buffers == times->warmUp )
+					times->start = now;
+				times->end = now;
+				return GST_PAD_PROBE_OK;
+			},
+			&times,
+			NULL );
+		gst_object_unref( pad );
+		gst_object_unref( sink );
+
+		// Run the pipeline until all frames went through
+		gst_element_set_state( pipeline, GST_STATE_PLAYING );
+		GstBus *bus = gst_element_get_bus( pipeline );
+		GstMessage *msg = gst_bus_timed_pop_filtered( bus, GST_CLOCK_TIME_NONE, (GstMessageType)( GST_MESSAGE_EOS | GST_MESSAGE_ERROR ) );
+		ASSERT_TRUE( msg != NULL );
+		EXPECT_EQ( GST_MESSAGE_TYPE( msg ), GST_MESSAGE_EOS );
+		EXPECT_EQ( times.buffers, numFrames );
+		ASSERT_GT( times.end, times.start );
+		fps[ connections ] = ( times.buffers - warmUp ) * (double)G_USEC_PER_SEC / ( times.end - times.start );
+		std::cout << "connections=" << connections << " : " << fps[ connections ] << " FPS\n";
+
+		gst_message_unref( msg );
+		gst_object_unref( bus );
+		gst_element_set_state( pipeline, GST_STATE_NULL );
+		gst_object_unref( pipeline );
+	}
+
+	// More connections keep more frames in flight: throughput must not drop, up to measurement noise
+	const double tolerance = 0.9;
+	EXPECT_GE( fps[ 2 ], tolerance * fps[ 1 ] );
+	EXPECT_GE( fps[ 4 ], tolerance * fps[ 1 ] );
+}
+
+// Test that frame encodings are made once per size and format and reused by later models, also across threads
+TEST( DgAcceleratorEncodedFrameTest, ReusePerSizeAndFormat )
+{
+	DgAcceleratorEncodedFrame encoded;
+	std::atomic< int > encodes{ 0 };
+	auto encoder = [ & ]( char value ) {
+		return [ &encodes, value ]() {
+			encodes++;
+			return DgAcceleratorEncodedFrame::Data{ std::vector< char >( 16, value ) };
+		};
+	};
+
+	// Models of the same resolution and format share the first encoding
+	const DgAcceleratorEncodedFrame::Data &first = encoded.get( 300, 300, "jpeg:85", encoder( 'a' ) );
+	const DgAcceleratorEncodedFrame::Data &second = encoded.get( 300, 300, "jpeg:85", encoder( 'b' ) );
+	EXPECT_EQ( encodes, 1 );
+	EXPECT_EQ( &first, &second );
+	EXPECT_EQ( second[ 0 ][ 0 ], 'a' );
+
+	// Another format or size is encoded separately, without replacing the encodings already handed out
+	const DgAcceleratorEncodedFrame::Data &other = encoded.get( 300, 300, "jpeg:95", encoder( 'c' ) );
+	EXPECT_EQ( encoded.get( 224, 224, "jpeg:85", encoder( 'd' ) )[ 0 ][ 0 ], 'd' );
+	EXPECT_EQ( encodes, 3 );
+	EXPECT_EQ( other[ 0 ][ 0 ], 'c' );
+	EXPECT_EQ( first[ 0 ][ 0 ], 'a' );
+	EXPECT_EQ( encoded.size(), 3u );
+
+	// Elements in several branches asking for the same encoding concurrently encode it once
+	DgAcceleratorEncodedFrame shared;
+	encodes = 0;
+	std::vector< std::thread > branches;
+	for( int t = 0; t < 8; t++ )
+		branches.emplace_back( [ & ]() { EXPECT_EQ( shared.get( 300, 300, "jpeg:85", encoder( 'e' ) )[ 0 ].size(), 16u ); } );
+	for( std::thread &branch : branches )
+		branch.join();
+	EXPECT_EQ( encodes, 1 );
+}
+
+// Test that model zoo cache files read back what was written, and that damaged files are rejected
+TEST( DgAcceleratorZooCacheTest, FileRoundTripAndValidation )
+{
+	char dir[] = "/tmp/dgaccelerator_zoo_XXXXXX";
+	ASSERT_NE( mkdtemp( dir ), nullptr );
+	const std::string path = std::string( dir ) + "/zoo.bin";
+	std::vector< DG::ModelInfo > models( 2 );
+	models[ 0 ].name = "yolo_v5s_coco--512x512_quant_n2x_orca_1";
+	models[ 0 ].W = 512;
+	models[ 0 ].H = 512;
+	models[ 1 ].name = "resnet50_imagenet--224x224_pruned_quant_n2x_orca_1";
+	models[ 1 ].W = 224;
+	models[ 1 ].H = 224;
+	DgAcceleratorZooCacheWrite( path, models );
+
+	std::vector< DG::ModelInfo > read;
+	ASSERT_TRUE( DgAcceleratorZooCacheRead( path, read ) );
+	ASSERT_EQ( read.size(), 2u );
+	for( size_t m = 0; m < models.size(); m++ )
+	{
+		EXPECT_EQ( read[ m ].name, models[ m ].name );
+		EXPECT_EQ( read[ m ].W, models[ m ].W );
+		EXPECT_EQ( read[ m ].H, models[ m ].H );
+	}
+
+	// Header: magic at 0, version at 4, record count at 8 and checksum at 12, followed by the records
+	std::ifstream file( path, std::ios::binary );
+	const std::string bytes( ( std::istreambuf_iterator< char >( file ) ), std::istreambuf_iterator< char >() );
+	file.close();
+	const std::string damaged = std::string( dir ) + "/damaged.bin";
+	auto rejected = [ & ]( const std::string &contents ) {
+		std::ofstream( damaged, std::ios::binary | std::ios::trunc ) << contents;
+		std::vector< DG::ModelInfo > models;
+		const bool valid = DgAcceleratorZooCacheRead( damaged, models );
+		return !valid && models.empty();
+	};
+	for( size_t offset : { (size_t)0, (size_t)4, (size_t)12, (size_t)20, bytes.size() - 1 } )
+	{
+		std::string contents = bytes;
+		contents[ offset ] ^= 0x5a;
+		EXPECT_TRUE( rejected( contents ) ) << "byte " << offset;
+	}
+	EXPECT_TRUE( rejected( bytes.substr( 0, bytes.size() - 3 ) ) );
+	EXPECT_TRUE( rejected( bytes.substr( 0, 8 ) ) );
+	EXPECT_FALSE( rejected( bytes ) );
+	EXPECT_FALSE( DgAcceleratorZooCacheRead( std::string( dir ) + "/missing.bin", read ) );
+
+	std::remove( path.c_str() );
+	std::remove( damaged.c_str() );
+	rmdir( dir );
+}
+
+// Test that the built-in tracker keeps IDs stable and extrapolates boxes on frames without results
+TEST( DgAcceleratorTrackerTest, StableIdsAndExtrapolation )
+{
+	DgAcceleratorTracker tracker( { 0.3f, 5 } );
+	DgAcceleratorLabelTable labels;
+	DgAcceleratorObject det = { 100, 100, 50, 80, 0.8f, 0, labels.intern( "person" ) };
+	DgAcceleratorTrackedObject tracks[ MAX_OBJ_PER_FRAME ];
+
+	// Object moving right by 10 pixels per frame
+	uint64_t id = 0;
+	for( int frame = 0; frame < 10; frame++ )
+	{
+		det.left = 100 + 10 * frame;
+		tracker.predict();
+		tracker.update( &det, 1 );
+		ASSERT_EQ( tracker.get( tracks, MAX_OBJ_PER_FRAME ), 1 );
+		if( frame == 0 )
+			id = tracks[ 0 ].id;
+		EXPECT_EQ( tracks[ 0 ].id, id );
+	}
+
+	// Frame without inference: the box keeps moving with the estimated velocity
+	tracker.predict();
+	ASSERT_EQ( tracker.get( tracks, MAX_OBJ_PER_FRAME ), 1 );
+	EXPECT_EQ( tracks[ 0 ].id, id );
+	EXPECT_NEAR( tracks[ 0 ].object.left, 200, 5 );
+	EXPECT_STREQ( labels.name( tracks[ 0 ].object.labelId ), "person" );
+	EXPECT_EQ( tracks[ 0 ].object.classId, 0 );
+	EXPECT_FLOAT_EQ( tracks[ 0 ].object.score, 0.8f );
+
+	// Another tracker, such as the one of another model or of a swapped model, never reuses the ID
+	DgAcceleratorTracker other( { 0.3f, 5 } );
+	other.predict();
+	other.update( &det, 1 );
+	ASSERT_EQ( other.get( tracks, MAX_OBJ_PER_FRAME ), 1 );
+	EXPECT_NE( tracks[ 0 ].id, id );
+
+	// Tracks are retired after max age frames without a matching detection
+	for( int frame = 0; frame < 6; frame++ )
+		tracker.predict();
+	EXPECT_EQ( tracker.size(), 0u );
+}
+
+// Test that the motion gate holds back static frames and lets frames with motion through
+TEST( DgAcceleratorMotionGateTest, StaticAndMovingFrames )
+{
+	DgAcceleratorMotionGate gate( { 0.01, 25, 5 } );
+	cv::Mat frame( 320, 320, CV_8UC3, cv::Scalar( 40, 40, 40 ) );
+	cv::rectangle( frame, cv::Rect( 20, 20, 64, 64 ), cv::Scalar( 220, 220, 220 ), cv::FILLED );
+
+	// The first frame has no reference and always needs inference
+	EXPECT_TRUE( gate.check( frame ) );
+	gate.accept();
+	// The same frame again is held back
+	EXPECT_FALSE( gate.check( frame ) );
+	EXPECT_FALSE( gate.check( frame.clone() ) );
+
+	// Moving the square changes far more than 1% of the thumbnail
+	cv::Mat moved( 320, 320, CV_8UC3, cv::Scalar( 40, 40, 40 ) );
+	cv::rectangle( moved, cv::Rect( 200, 200, 64, 64 ), cv::Scalar( 220, 220, 220 ), cv::FILLED );
+	EXPECT_TRUE( gate.check( moved ) );
+	// A frame let through but not accepted (dropped) leaves the reference, so the change is let through again
+	EXPECT_TRUE( gate.check( moved ) );
+	gate.accept();
+	EXPECT_FALSE( gate.check( moved ) );
+
+	// A static scene is still let through after max skip frames in a row
+	int held = 0;
+	while( !gate.check( moved ) )
+		held++;
+	EXPECT_EQ( held, 4 );
+}
+
+// Test that labels are interned once and resolved back to the same strings
+TEST( DgAcceleratorLabelTableTest, InternAndResolve )
+{
+	DgAcceleratorLabelTable labels;
+	EXPECT_EQ( labels.size(), 1u );
+	EXPECT_STREQ( labels.name( 0 ), "" );
+
+	const uint16_t person = labels.intern( "person" );
+	const uint16_t car = labels.intern( "car" );
+	EXPECT_NE( person, 0 );
+	EXPECT_NE( person, car );
+	EXPECT_EQ( labels.intern( "person" ), person );
+	EXPECT_EQ( labels.size(), 3u );
+
+	// Resolved strings stay valid while more labels are added
+	const char *name = labels.name( person );
+	for( int i = 0; i < 1000; i++ )
+		labels.intern( "label " + std::to_string( i ) );
+	EXPECT_STREQ( name, "person" );
+	EXPECT_STREQ( labels.name( car ), "car" );
+	EXPECT_STREQ( labels.name( 60000 ), "" );
+}
+
+// Test that nearly identical frames hit the result cache and different frames miss it
+TEST( DgAcceleratorResultCacheTest, NearDuplicateFrames )
+{
+	cv::Mat frame( 300, 300, CV_8UC3 );
+	cv::randu( frame, 0, 256 );
+	cv::Mat noisy = frame.clone();
+	noisy.at< cv::Vec3b >( 10, 10 ) = cv::Vec3b( 0, 0, 0 );  // Single pixel change
+	cv::Mat other( 300, 300, CV_8UC3 );
+	cv::randu( other, 0, 256 );
+
+	DgAcceleratorResultCache cache( { 2, 2, 30 } );
+	DgAcceleratorOutput *output = new DgAcceleratorOutput();
+	output->numObjects = 1;
+	cache.insert( DgAcceleratorDHash( frame ), *output );
+
+	const DgAcceleratorOutput *hit = cache.find( DgAcceleratorDHash( noisy ) );
+	ASSERT_NE( hit, nullptr );
+	EXPECT_EQ( hit->numObjects, 1 );
+	EXPECT_EQ( cache.find( DgAcceleratorDHash( other ) ), nullptr );
+
+	// Least recently used entry is evicted when full
+	output->numObjects = 2;
+	cache.insert( DgAcceleratorDHash( other ), *output );
+	cache.insert( ~DgAcceleratorDHash( frame ), *output );
+	EXPECT_EQ( cache.size(), 2u );
+	EXPECT_EQ( cache.find( DgAcceleratorDHash( frame ) ), nullptr );
+
+	// An entry which served max reuse lookups is dropped so that the next matching frame is inferred
+	DgAcceleratorResultCache limited( { 2, 2, 2 } );
+	limited.insert( DgAcceleratorDHash( frame ), *output );
+	EXPECT_NE( limited.find( DgAcceleratorDHash( frame ) ), nullptr );
+	EXPECT_NE( limited.find( DgAcceleratorDHash( noisy ) ), nullptr );
+	EXPECT_EQ( limited.find( DgAcceleratorDHash( frame ) ), nullptr );
+	EXPECT_EQ( limited.size(), 0u );
+	limited.insert( DgAcceleratorDHash( frame ), *output );
+	EXPECT_NE( limited.find( DgAcceleratorDHash( frame ) ), nullptr );
+	delete output;
+}
+
+// Test that tiles cover the frame with overlap and that detections split by tile borders are merged
+TEST( DgAcceleratorTilingTest, LayoutAndMerge )
+{
+	std::vector< DgAcceleratorTile > tiles = DgAcceleratorTileLayout( 1000, 300, 500, 300, 0.2 );
+	ASSERT_EQ( tiles.size(), 3u );
+	EXPECT_EQ( tiles.front().left, 0 );
+	EXPECT_EQ( tiles.back().left + tiles.back().width, 1000 );
+	for( size_t t = 1; t < tiles.size(); t++ )
+		EXPECT_GE( tiles[ t - 1 ].left + tiles[ t - 1 ].width - tiles[ t ].left, 100 );
+
+	// Two tiles of a 800x300 region at 500x300 processing resolution, tiles at x = 0 and x = 300
+	tiles = DgAcceleratorTileLayout( 800, 300, 500, 300, 0.2 );
+	ASSERT_EQ( tiles.size(), 2u );
+	DgAcceleratorOutput *outputs[ 2 ] = { new DgAcceleratorOutput(), new DgAcceleratorOutput() };
+	DgAcceleratorLabelTable labels;
+	const uint16_t person = labels.intern( "person" ), car = labels.intern( "car" );
+	// Car at x = 350..450 in the region: whole in both tiles, and a person cut by the right border of the first tile.
+	// A large low-confidence car at x = 320..480 of the first tile holds a confident car at x = 340..400 of the second.
+	outputs[ 0 ]->numObjects = 3;
+	outputs[ 0 ]->object[ 0 ] = { 350, 100, 100, 50, 0.9f, 2, car };
+	outputs[ 0 ]->object[ 1 ] = { 460, 100, 40, 100, 0.75f, 0, person };
+	outputs[ 0 ]->object[ 2 ] = { 320, 20, 160, 60, 0.3f, 2, car };
+	// Second tile only: a car partly hidden by another car at x = 600..700, kept as the model's NMS kept it
+	outputs[ 1 ]->numObjects = 5;
+	outputs[ 1 ]->object[ 0 ] = { 50, 100, 100, 50, 0.8f, 2, car };
+	outputs[ 1 ]->object[ 1 ] = { 160, 100, 80, 100, 0.7f, 0, person };
+	outputs[ 1 ]->object[ 2 ] = { 300, 200, 100, 50, 0.9f, 2, car };
+	outputs[ 1 ]->object[ 3 ] = { 310, 210, 40, 30, 0.8f, 2, car };
+	outputs[ 1 ]->object[ 4 ] = { 40, 30, 60, 30, 0.9f, 2, car };
+	outputs[ 1 ]->inferred = true;
+
+	DgAcceleratorOutput *merged = new DgAcceleratorOutput();
+	DgAcceleratorMergeTiles( tiles, outputs, 800, 300, 500, 300, 0.5f, *merged );
+	ASSERT_EQ( merged->numObjects, 5 );
+	EXPECT_TRUE( merged->inferred );
+	EXPECT_FALSE( outputs[ 1 ]->inferred );
+	// Merged boxes are in processing resolution coordinates of the whole region: x scaled by 500 / 800. Whole objects
+	// come first, by decreasing score then area.
+	EXPECT_EQ( merged->object[ 0 ].labelId, car );
+	EXPECT_EQ( merged->object[ 0 ].classId, 2 );
+	EXPECT_NEAR( merged->object[ 0 ].left, 350 * 500 / 800.0, 1e-3 );
+	EXPECT_NEAR( merged->object[ 1 ].left, 600 * 500 / 800.0, 1e-3 );
+	// The confident car wins over the large low-confidence one
+	EXPECT_NEAR( merged->object[ 2 ].left, 340 * 500 / 800.0, 1e-3 );
+	EXPECT_FLOAT_EQ( merged->object[ 2 ].score, 0.9f );
+	EXPECT_NEAR( merged->object[ 3 ].left, 610 * 500 / 800.0, 1e-3 );
+	// The whole person wins over its part cut by the tile border, despite the higher score of the part
+	EXPECT_EQ( merged->object[ 4 ].labelId, person );
+	EXPECT_NEAR( merged->object[ 4 ].left, 460 * 500 / 800.0, 1e-3 );
+	EXPECT_NEAR( merged->object[ 4 ].width, 80 * 500 / 800.0, 1e-3 );
+	EXPECT_FLOAT_EQ( merged->object[ 4 ].score, 0.7f );
+	delete outputs[ 0 ];
+	delete outputs[ 1 ];
+	delete merged;
+}
+
+// Test that mask buffers are shared by reference and recycled by the pool once released
+TEST( DgAcceleratorMaskPoolTest, SharingAndReuse )
+{
+	const size_t bytes = 513 * 513;
+	DgAcceleratorMaskBuffer buffer = DgAcceleratorMaskAcquire( bytes );
+	uint8_t *data = buffer.get();
+	data[ 0 ] = 7;
+
+	// A copy keeps the buffer alive after the original reference is dropped
+	DgAcceleratorMaskBuffer copy = buffer;
+	buffer.reset();
+	EXPECT_EQ( copy.get(), data );
+	EXPECT_EQ( copy.get()[ 0 ], 7 );
+	copy.reset();
+
+	// The released buffer is handed out again without allocating
+	const DgAcceleratorMaskPoolStats before = DgAcceleratorMaskPoolGetStats();
+	DgAcceleratorMaskBuffer reused = DgAcceleratorMaskAcquire( bytes );
+	const DgAcceleratorMaskPoolStats after = DgAcceleratorMaskPoolGetStats();
+	EXPECT_EQ( reused.get(), data );
+	EXPECT_EQ( after.acquired, before.acquired + 1 );
+	EXPECT_EQ( after.allocated, before.allocated );
+}
+
+// Benchmark the class map bytes written and allocated per frame from the parsed model response to the segmentation
+// metadata and its copies, at 513x513 -> 1080p, as counted by the mask pool
+TEST( DgAcceleratorMaskPoolTest, BytesCopiedBenchmark )
+{
+	const int maskW = 513, maskH = 513, frameW = 1920, frameH = 1080, numFrames = 100;
+	const size_t maskCount = maskW * maskH, frameCount = frameW * frameH;
+	std::vector< uint8_t > payload( maskCount );  // Binary "data" field of the model response
+	for( size_t i = 0; i < maskCount; i++ )
+		payload[ i ] = ( i / maskW / 32 + i % maskW / 32 ) % 21;
+
+	DgAcceleratorMaskUpscaler upscaler;
+	std::unique_ptr< DgAcceleratorOutput > output( new DgAcceleratorOutput() );
+	std::unique_ptr< DgAcceleratorOutput > kept( new DgAcceleratorOutput() );
+
+	// One frame with the given segmentation-output: parse, keep the results for gated and cached frames, attach, copy
+	// the metadata twice as downstream elements do
+	auto frame = [ & ]( bool frameOutput ) {
+		output->segMap.class_map = DgAcceleratorMaskConvert( payload.data(), maskCount, 1, frameOutput ? 1 : sizeof( int ) );
+		output->segMap.element_size = frameOutput ? 1 : sizeof( int );
+		output->segMap.mask_width = maskW;
+		output->segMap.mask_height = maskH;
+		*kept = *output;
+
+		DgAcceleratorMaskBuffer attached = output->segMap.class_map;
+		if( frameOutput )
+		{
+			attached = DgAcceleratorMaskAcquire( frameCount * sizeof( int ) );
+			upscaler.upscale( output->segMap.class_map.get(), maskW, maskH, (int32_t *)attached.get(), frameW, frameW, frameH );
+		}
+		DgAcceleratorMaskBuffer *priv = new DgAcceleratorMaskBuffer( attached );
+		DgAcceleratorMaskBuffer *copy1 = new DgAcceleratorMaskBuffer( *priv );
+		DgAcceleratorMaskBuffer *copy2 = new DgAcceleratorMaskBuffer( *copy1 );
+		EXPECT_EQ( copy2->get(), attached.get() );
+		delete priv;
+		delete copy1;
+		delete copy2;
+	};
+
+	for( bool frameOutput : { true, false } )
+	{
+		// The first frames fill the pool with the buffers held across frames
+		frame( frameOutput );
+		frame( frameOutput );
+		const DgAcceleratorMaskPoolStats before = DgAcceleratorMaskPoolGetStats();
+		const gint64 start = g_get_monotonic_time();
+		for( int f = 0; f < numFrames; f++ )
+			frame( frameOutput );
+		const gint64 time = g_get_monotonic_time() - start;
+		const DgAcceleratorMaskPoolStats after = DgAcceleratorMaskPoolGetStats();
+
+		const uint64_t written = ( after.bytesWritten - before.bytesWritten ) / numFrames;
+		std::cout << "segmentation-output=" << ( frameOutput ? "frame" : "model" ) << ": "
+				  << (double)( after.acquired - before.acquired ) / numFrames << " buffers acquired, "
+				  << (double)( after.allocated - before.allocated ) / numFrames << " allocated ("
+				  << ( after.bytesAllocated - before.bytesAllocated ) / numFrames << " bytes), " << written
+				  << " bytes written per frame, " << (double)time / numFrames << " us per frame\n";
+
+		// The class map is written once by the parser, plus once at frame size when upscaled; metadata copies and
+		// kept results share it, and the pooled buffers are recycled
+		EXPECT_EQ( written, frameOutput ? maskCount + frameCount * sizeof( int ) : maskCount * sizeof( int ) );
+		EXPECT_EQ( after.allocated, before.allocated );
+		EXPECT_EQ( after.bytesAllocated, before.bytesAllocated );
+	}
+}
+
+// Test that the class map upscaler matches cv::resize with INTER_NEAREST, and benchmark both at 513x513 -> 1080p
+TEST( DgAcceleratorMaskUpscalerTest, MatchesResizeBenchmark )
+{
+	const int maskW = 513, maskH = 513, frameW = 1920, frameH = 1080, numFrames = 100;
+	cv::Mat mask( maskH, maskW, CV_8U );
+	cv::randu( mask, 0, 21 );
+	cv::Mat mask32;
+	mask.convertTo( mask32, CV_32S );
+
+	// cv::resize of the int32 map into a reused frame sized map
+	cv::Mat expected( frameH, frameW, CV_32S );
+	cv::resize( mask32, expected, expected.size(), 0, 0, cv::INTER_NEAREST );
+	gint64 start = g_get_monotonic_time();
+	for( int f = 0; f < numFrames; f++ )
+		cv::resize( mask32, expected, expected.size(), 0, 0, cv::INTER_NEAREST );
+	const gint64 resizeTime = g_get_monotonic_time() - start;
+
+	// Upscaler writing into a reused frame sized map, index tables built by the first call
+	DgAcceleratorMaskUpscaler upscaler;
+	cv::Mat upscaled( frameH, frameW, CV_32S );
+	upscaler.upscale( mask.data, maskW, maskH, (int32_t *)upscaled.data, frameW, frameW, frameH );
+	start = g_get_monotonic_time();
+	for( int f = 0; f < numFrames; f++ )
+		upscaler.upscale( mask.data, maskW, maskH, (int32_t *)upscaled.data, frameW, frameW, frameH );
+	const gint64 upscaleTime = g_get_monotonic_time() - start;
+
+	EXPECT_EQ( cv::countNonZero( expected != upscaled ), 0 );
+	std::cout << "cv::resize INTER_NEAREST : " << resizeTime / (double)numFrames << " us per frame\n";
+	std::cout << "upscaler : " << upscaleTime / (double)numFrames << " us per frame\n";
+
+	// Upscaling into a region matches cv::resize there and leaves the rest of the map untouched
+	const cv::Rect region( 200, 100, 643, 361 );
+	upscaled.setTo( -1 );
+	upscaler.upscale( mask.data, maskW, maskH, (int32_t *)upscaled.ptr( region.y, region.x ), frameW, region.width, region.height );
+	cv::Mat expectedRegion;
+	cv::resize( mask32, expectedRegion, region.size(), 0, 0, cv::INTER_NEAREST );
+	EXPECT_EQ( cv::countNonZero( upscaled( region ) != expectedRegion ), 0 );
+	EXPECT_EQ( cv::countNonZero( upscaled != -1 ), region.area() );
+
+	// Downscaling, where some mask columns have no destination column
+	cv::Mat downscaled( 300, 200, CV_32S );
+	upscaler.upscale( mask.data, maskW, maskH, (int32_t *)downscaled.data, downscaled.cols, downscaled.cols, downscaled.rows );
+	cv::resize( mask32, expected, downscaled.size(), 0, 0, cv::INTER_NEAREST );
+	EXPECT_EQ( cv::countNonZero( expected != downscaled ), 0 );
+}
+
+// Test the per-class statistics of a class map
+TEST( DgAcceleratorMaskStatsTest, AreaCentroidAndBox )
+{
+	// Background of class 0 with a 20x10 rectangle of class 3 at (30, 5) and a single pixel of class 7
+	const int width = 64, height = 32;
+	std::vector< uint8_t > classMap( width * height, 0 );
+	for( int y = 5; y < 15; y++ )
+		for( int x = 30; x < 50; x++ )
+			classMap[ y * width + x ] = 3;
+	classMap[ 31 * width + 63 ] = 7;
+
+	std::vector< DgAcceleratorClassStats > stats;
+	DgAcceleratorMaskStats( classMap.data(), width, height, stats );
+	ASSERT_EQ( stats.size(), 3u );
+	EXPECT_EQ( stats[ 0 ].classId, 0 );
+	EXPECT_EQ( stats[ 0 ].area, (uint64_t)( width * height - 200 - 1 ) );
+	EXPECT_EQ( stats[ 1 ].classId, 3 );
+	EXPECT_EQ( stats[ 1 ].area, 200u );
+	EXPECT_DOUBLE_EQ( (double)stats[ 1 ].sumX / stats[ 1 ].area, 39.5 );
+	EXPECT_DOUBLE_EQ( (double)stats[ 1 ].sumY / stats[ 1 ].area, 9.5 );
+	EXPECT_EQ( stats[ 1 ].left, 30 );
+	EXPECT_EQ( stats[ 1 ].right, 49 );
+	EXPECT_EQ( stats[ 1 ].top, 5 );
+	EXPECT_EQ( stats[ 1 ].bottom, 14 );
+	EXPECT_EQ( stats[ 2 ].classId, 7 );
+	EXPECT_EQ( stats[ 2 ].area, 1u );
+	EXPECT_EQ( stats[ 2 ].left, 63 );
+	EXPECT_EQ( stats[ 2 ].top, 31 );
+}
+
+// Test that regions of a class map are outlined by simplified polygons, without the background
+TEST( DgAcceleratorMaskPolygonsTest, SimplifiedOutlines )
+{
+	// Rectangle of class 2 and a staircase triangle of class 5 on a background of class 0
+	const int width = 100, height = 100;
+	std::vector< uint8_t > classMap( width * height, 0 );
+	for( int y = 10; y < 40; y++ )
+		for( int x = 20; x < 60; x++ )
+			classMap[ y * width + x ] = 2;
+	for( int y = 50; y < 90; y++ )
+		for( int x = 10; x < 10 + ( y - 50 ); x++ )
+			classMap[ y * width + x ] = 5;
+
+	std::vector< DgAcceleratorPolygon > polygons;
+	DgAcceleratorMaskPolygons( classMap.data(), width, height, 1.5, polygons );
+	ASSERT_EQ( polygons.size(), 2u );
+	EXPECT_EQ( polygons[ 0 ].classId, 2 );
+	ASSERT_EQ( polygons[ 0 ].points.size(), 4u );
+	const cv::Rect box = cv::boundingRect( polygons[ 0 ].points );
+	EXPECT_EQ( box, cv::Rect( 20, 10, 40, 30 ) );
+	// The staircase edge is simplified into a straight line
+	EXPECT_EQ( polygons[ 1 ].classId, 5 );
+	EXPECT_LE( polygons[ 1 ].points.size(), 4u );
+}
+
 int main( int argc, char **argv )
 {
 	// Initialize GStreamer